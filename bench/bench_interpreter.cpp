@@ -0,0 +1,482 @@
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <sstream>
+
+#include "builtin_defines.h"
+#include "constant_folder.h"
+#include "tkom_interpreter.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace po = boost::program_options;
+
+static size_t allocations = 0;  //< number of allocations made by the program so far
+static size_t allocated_bytes = 0;  //< number of bytes allocated by the program so far
+
+// the replacements are kept out of line, so that the compiler does not pair an inlined
+// `std::free` with the `operator new` it frees and warn about a mismatched deallocation
+[[gnu::noinline]] auto operator new(size_t size) -> void * {
+    allocations++;
+    allocated_bytes += size;
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *memory) noexcept { std::free(memory); }
+
+[[gnu::noinline]] void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+/**
+ * @brief counter of instructions retired in user space, where the platform exposes one
+ */
+class InstructionCounter {
+   private:
+    int fd = -1;  //< the perf event, negative if unavailable
+
+   public:
+    InstructionCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    InstructionCounter(const InstructionCounter &) = delete;
+    auto operator=(const InstructionCounter &) -> InstructionCounter & = delete;
+
+    ~InstructionCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    auto stop() -> std::optional<uint64_t> {
+#ifdef __linux__
+        if (fd < 0) return std::nullopt;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(fd, &count, sizeof(count)) == sizeof(count)) return count;
+#endif
+        return std::nullopt;
+    }
+};
+
+/**
+ * @brief the cost of a single phase of running a program
+ */
+struct PhaseStats {
+    double seconds = 0;  //< wall time
+    std::optional<uint64_t> instructions;  //< instructions retired, if they can be counted
+    size_t allocations = 0;  //< number of allocations
+    size_t allocated_bytes = 0;  //< number of bytes allocated
+
+    /**
+     * @brief keep the cheaper of two runs, allocations do not vary between runs
+     */
+    void keep_best(const PhaseStats &other) {
+        seconds = std::min(seconds, other.seconds);
+        if (instructions && other.instructions) {
+            instructions = std::min(*instructions, *other.instructions);
+        }
+    }
+};
+
+/**
+ * @brief a program to benchmark
+ */
+struct Workload {
+    std::string name;  //< name of the workload, as reported
+    std::string source;  //< the program, or the path to it
+    From from;  //< whether `source` is the program itself or a path
+    std::string input;  //< the standard input of the program
+};
+
+/**
+ * @brief the phases of running a program, in the order in which they run
+ */
+enum class Phase { LEX = 0, PARSE, FOLD, INTERPRET };
+
+static constexpr std::array<const char *, 4> phase_names{"lex", "parse", "fold", "interpret"};
+
+/**
+ * @brief the cost of running a workload with an engine
+ */
+struct WorkloadStats {
+    std::string name;  //< name of the workload
+    std::string engine;  //< name of the engine
+    std::array<PhaseStats, 4> phases;  //< the cost of each phase
+    std::string error;  //< why the workload failed, empty if it did not
+};
+
+/**
+ * @brief stream buffer discarding everything written into it
+ */
+class NullBuffer : public std::streambuf {
+   protected:
+    auto overflow(int c) -> int override { return c; }
+};
+
+/**
+ * @brief scale an iteration count, never below one
+ */
+static auto scaled(double scale, double count) -> std::string {
+    return std::to_string(std::max<long>(1, static_cast<long>(count * scale)));
+}
+
+static auto make_workloads(const std::string &examples, double scale) -> std::vector<Workload> {
+    std::vector<Workload> workloads{
+        {"recur_sum", examples + "/recur_sum.tkom", From::FILE, "1000\n"},
+        {"high_order", examples + "/high_order.tkom", From::FILE, ""},
+        {"quadriatic", examples + "/quadriatic.tkom", From::FILE, "1 -3 2\n"},
+    };
+    workloads.push_back({"deep_recursion",
+                         "int sum :: int n {\n"
+                         "    if (n <= 0) {\n"
+                         "        ret 0;\n"
+                         "    }\n"
+                         "    ret ((n - 1) -> sum) + n;\n"
+                         "}\n"
+                         "int main {\n"
+                         "    0 => mut int total;\n"
+                         "    for (0 => mut int i; i < " + scaled(scale, 40) + ") {\n"
+                         "        total + (5000) -> sum => total;\n"
+                         "    } -> increment;\n"
+                         "    ret 0;\n"
+                         "}\n",
+                         From::STRING, ""});
+    workloads.push_back({"for_loop",
+                         "int main {\n"
+                         "    0 => mut int total;\n"
+                         "    for (0 => mut int i; i < " + scaled(scale, 2000000) + ") {\n"
+                         "        total + i * 2 - 1 => total;\n"
+                         "    } -> increment;\n"
+                         "    ret 0;\n"
+                         "}\n",
+                         From::STRING, ""});
+    workloads.push_back({"block_locals",
+                         "int main {\n"
+                         "    0 => mut int total;\n"
+                         "    for (0 => mut int i; i < " + scaled(scale, 500000) + ") {\n"
+                         "        i * 2 => int twice;\n"
+                         "        twice / 3.0 => flt third;\n"
+                         "        if (third > 1) {\n"
+                         "            third - 1 => int rest;\n"
+                         "            total + rest => total;\n"
+                         "        }\n"
+                         "    } -> increment;\n"
+                         "    ret 0;\n"
+                         "}\n",
+                         From::STRING, ""});
+    workloads.push_back({"string_concat",
+                         "int main {\n"
+                         "    \"\" => mut string text;\n"
+                         "    for (0 => mut int i; i < " + scaled(scale, 20000) + ") {\n"
+                         "        text + \"ab\" => text;\n"
+                         "    } -> increment;\n"
+                         "    ret 0;\n"
+                         "}\n",
+                         From::STRING, ""});
+    workloads.push_back({"decorator_chain",
+                         "int twice :: [int::int] func, int a {\n"
+                         "    ret ((a) -> func) -> func;\n"
+                         "}\n"
+                         "int add_1 :: int a {\n"
+                         "    ret a + 1;\n"
+                         "}\n"
+                         "int main {\n"
+                         "    add_1 @ twice => [int::int] add_2;\n"
+                         "    add_2 @ twice => [int::int] add_4;\n"
+                         "    add_4 @ twice => [int::int] add_8;\n"
+                         "    0 => mut int total;\n"
+                         "    for (0 => mut int i; i < " + scaled(scale, 100000) + ") {\n"
+                         "        (total + 1) -> add_8 => total;\n"
+                         "    } -> increment;\n"
+                         "    ret 0;\n"
+                         "}\n",
+                         From::STRING, ""});
+    workloads.push_back({"bind_chain",
+                         "int add :: int a, int b, int c, int d {\n"
+                         "    ret a + b + c + d;\n"
+                         "}\n"
+                         "int main {\n"
+                         "    (1) ->> add => [int::int, int, int] add_1;\n"
+                         "    (2) ->> add_1 => [int::int, int] add_3;\n"
+                         "    (3) ->> add_3 => [int::int] add_6;\n"
+                         "    0 => mut int total;\n"
+                         "    for (0 => mut int i; i < " + scaled(scale, 200000) + ") {\n"
+                         "        (total + 1) -> add_6 => total;\n"
+                         "    } -> increment;\n"
+                         "    ret 0;\n"
+                         "}\n",
+                         From::STRING, ""});
+    return workloads;
+}
+
+/**
+ * @brief run a phase, measuring its cost
+ */
+template <typename F>
+static auto measure(InstructionCounter &counter, F &&phase) -> PhaseStats {
+    PhaseStats stats;
+    const size_t allocations_before = allocations;
+    const size_t bytes_before = allocated_bytes;
+    const auto start = std::chrono::steady_clock::now();
+    counter.start();
+    phase();
+    stats.instructions = counter.stop();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.allocations = allocations - allocations_before;
+    stats.allocated_bytes = allocated_bytes - bytes_before;
+    return stats;
+}
+
+/**
+ * @brief run a workload once, the way `TKOMInterpreter::process` does, timing each phase
+ *
+ * Parsing drives its own lexer, so the parse phase includes lexing once more
+ */
+static auto run_once(const Workload &workload, EngineKind engine, OptLevel opt_level,
+                     InstructionCounter &counter) -> std::array<PhaseStats, 4> {
+    std::shared_ptr<const SourceBuffer> source;
+    if (workload.from == From::FILE) {
+        source = SourceBuffer::from_file(workload.source);
+    } else {
+        std::istringstream input(workload.source);
+        source = SourceBuffer::from_stream(input);
+    }
+
+    std::array<PhaseStats, 4> phases;
+    phases[static_cast<size_t>(Phase::LEX)] = measure(counter, [&] {
+        Lexer lexer(source);
+        while (!lexer.end()) lexer.get_token();
+    });
+
+    std::unique_ptr<Program> program;
+    phases[static_cast<size_t>(Phase::PARSE)] = measure(counter, [&] {
+        Parser parser(std::make_shared<Lexer>(source));
+        program = parser.parse();
+    });
+
+    phases[static_cast<size_t>(Phase::FOLD)] = measure(counter, [&] {
+        if (opt_level < OptLevel::O1) return;
+        ConstantFolder folder;
+        program->accept(folder);
+    });
+
+    // the engines are constructed outside of the measured phase, like in TKOMInterpreter
+    InterpreterVisitor interpreter(builtins);
+    VirtualMachine vm(builtins);
+    std::istringstream input(workload.input);
+    NullBuffer null_buffer;
+    auto *const cin_buffer = std::cin.rdbuf(input.rdbuf());
+    auto *const cout_buffer = std::cout.rdbuf(&null_buffer);
+    ValType ret_code;
+    try {
+        phases[static_cast<size_t>(Phase::INTERPRET)] = measure(counter, [&] {
+            if (engine == EngineKind::TREE) {
+                program->accept(interpreter);
+                ret_code = interpreter.get_value();
+            } else {
+                vm.run(*program);
+                ret_code = vm.get_value();
+            }
+        });
+    } catch (...) {
+        std::cin.rdbuf(cin_buffer);
+        std::cout.rdbuf(cout_buffer);
+        throw;
+    }
+    std::cin.rdbuf(cin_buffer);
+    std::cout.rdbuf(cout_buffer);
+
+    if (!std::holds_alternative<int>(ret_code)) {
+        throw InterpreterError("main must return an integer value");
+    }
+    return phases;
+}
+
+static auto run_workload(const Workload &workload, EngineKind engine, OptLevel opt_level,
+                         unsigned repeat, InstructionCounter &counter) -> WorkloadStats {
+    WorkloadStats stats{workload.name, engine == EngineKind::TREE ? "tree" : "vm", {}, {}};
+    try {
+        for (unsigned i = 0; i < repeat; ++i) {
+            const auto phases = run_once(workload, engine, opt_level, counter);
+            for (size_t phase = 0; phase < phases.size(); ++phase) {
+                if (i == 0) {
+                    stats.phases[phase] = phases[phase];
+                } else {
+                    stats.phases[phase].keep_best(phases[phase]);
+                }
+            }
+        }
+    } catch (const std::exception &e) {
+        stats.error = e.what();
+    }
+    return stats;
+}
+
+static void print_table(std::ostream &os, const std::vector<WorkloadStats> &results) {
+    os << std::left << std::setw(16) << "workload" << std::setw(6) << "engine";
+    for (const char *phase : phase_names) os << std::right << std::setw(12) << phase;
+    os << std::setw(14) << "instructions" << std::setw(12) << "allocs" << std::endl;
+
+    for (const auto &result : results) {
+        os << std::left << std::setw(16) << result.name << std::setw(6) << result.engine;
+        if (!result.error.empty()) {
+            os << "failed: " << result.error << std::endl;
+            continue;
+        }
+        std::optional<uint64_t> instructions = 0;
+        size_t allocs = 0;
+        for (const auto &phase : result.phases) {
+            os << std::right << std::fixed << std::setprecision(4) << std::setw(11)
+               << phase.seconds << "s";
+            instructions = instructions && phase.instructions
+                               ? std::optional(*instructions + *phase.instructions)
+                               : std::nullopt;
+            allocs += phase.allocations;
+        }
+        os << std::setw(14) << (instructions ? std::to_string(*instructions) : "n/a")
+           << std::setw(12) << allocs << std::endl;
+    }
+}
+
+/**
+ * @brief quote a string for JSON
+ */
+static auto json_string(const std::string &text) -> std::string {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            std::ostringstream escape;
+            escape << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c);
+            quoted += escape.str();
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + '"';
+}
+
+static void print_json(std::ostream &os, const std::vector<WorkloadStats> &results, int opt_level,
+                       unsigned repeat, double scale) {
+    os << "{\n  \"opt_level\": " << opt_level << ",\n  \"repeat\": " << repeat
+       << ",\n  \"scale\": " << scale << ",\n  \"workloads\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto &result = results[i];
+        os << (i ? "," : "") << "\n    {\"name\": " << json_string(result.name)
+           << ", \"engine\": " << json_string(result.engine) << ", ";
+        if (!result.error.empty()) {
+            os << "\"error\": " << json_string(result.error) << "}";
+            continue;
+        }
+        os << "\"phases\": {";
+        for (size_t phase = 0; phase < result.phases.size(); ++phase) {
+            const auto &stats = result.phases[phase];
+            os << (phase ? ", " : "") << "\"" << phase_names[phase] << "\": {\"seconds\": "
+               << std::setprecision(9) << stats.seconds << ", \"instructions\": "
+               << (stats.instructions ? std::to_string(*stats.instructions) : "null")
+               << ", \"allocations\": " << stats.allocations
+               << ", \"allocated_bytes\": " << stats.allocated_bytes << "}";
+        }
+        os << "}}";
+    }
+    os << "\n  ]\n}" << std::endl;
+}
+
+auto main(int argc, char **argv) -> int {
+    std::string engine_name;
+    std::string examples = TKOM_EXAMPLES_DIR;
+    std::string json_file;
+    std::string filter;
+    int opt_level = 1;
+    unsigned repeat = 3;
+    double scale = 1;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()("engine", po::value<std::string>(&engine_name)->default_value("both"),
+                       "execution engine: vm, tree or both")(
+        "optimize,O", po::value<int>(&opt_level)->default_value(1),
+        "optimization level: 0 (none) or 1 (constant folding)")(
+        "repeat,r", po::value<unsigned>(&repeat), "number of runs, the best one is reported")(
+        "scale,s", po::value<double>(&scale), "scale the iteration counts of synthetic workloads")(
+        "filter,f", po::value<std::string>(&filter), "only run workloads containing this string")(
+        "examples", po::value<std::string>(&examples), "directory containing the example programs")(
+        "json", po::value<std::string>(&json_file), "write the results as JSON, '-' for stdout")(
+        "help,h", "show help message");
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+        po::notify(vm);
+    } catch (const std::exception &e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help")) {
+        std::cout << "usage: bench_interpreter [options]" << std::endl << desc << std::endl;
+        return 0;
+    }
+
+    std::vector<EngineKind> engines;
+    if (engine_name == "vm" || engine_name == "both") engines.push_back(EngineKind::VM);
+    if (engine_name == "tree" || engine_name == "both") engines.push_back(EngineKind::TREE);
+    if (engines.empty() || (opt_level != 0 && opt_level != 1) || repeat == 0) {
+        std::cerr << "usage: bench_interpreter [options]" << std::endl << desc << std::endl;
+        return 1;
+    }
+
+    InstructionCounter counter;
+    std::vector<WorkloadStats> results;
+    for (const auto &workload : make_workloads(examples, scale)) {
+        if (workload.name.find(filter) == std::string::npos) continue;
+        for (EngineKind engine : engines) {
+            results.push_back(run_workload(workload, engine, static_cast<OptLevel>(opt_level),
+                                           repeat, counter));
+        }
+    }
+
+    if (json_file == "-") {
+        print_json(std::cout, results, opt_level, repeat, scale);
+    } else {
+        print_table(std::cout, results);
+        if (!json_file.empty()) {
+            std::ofstream json(json_file);
+            print_json(json, results, opt_level, repeat, scale);
+        }
+    }
+
+    for (const auto &result : results) {
+        if (!result.error.empty()) return 1;
+    }
+    return 0;
+}
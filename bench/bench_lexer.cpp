@@ -0,0 +1,149 @@
+#include <boost/program_options.hpp>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "exceptions.h"
+#include "lexer.h"
+#include "source_generator.h"
+
+namespace po = boost::program_options;
+
+static constexpr size_t token_types = static_cast<size_t>(TokenType::T_FUNC_SIGN_ST) + 1;
+
+/**
+ * @brief the outcome of lexing a document once
+ */
+struct LexRun {
+    size_t tokens = 0;  //< the number of tokens produced, including EOF
+    double seconds = 0;  //< the wall time it took
+    std::array<size_t, token_types> counts{};  //< the number of tokens of each type
+};
+
+/**
+ * @brief check whether the lexer can hand out tokens of the given type
+ *
+ * Errors are never returned as tokens, the `_ST` types are intermediate states of operators
+ */
+static auto is_producible(TokenType type) -> bool {
+    switch (type) {
+        case TokenType::T_ERROR:
+        case TokenType::T_EQ_ST:
+        case TokenType::T_AND_ST:
+        case TokenType::T_OR_ST:
+        case TokenType::T_FUNC_SIGN_ST:
+            return false;
+        default:
+            return true;
+    }
+}
+
+static auto lex_once(const std::shared_ptr<const SourceBuffer> &source) -> LexRun {
+    LexRun run;
+    const auto start = std::chrono::steady_clock::now();
+    Lexer lexer(source);
+    while (!lexer.end()) {
+        run.counts[static_cast<size_t>(lexer.get_token().get_type())]++;
+        run.tokens++;
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+auto main(int argc, char **argv) -> int {
+    std::string input_file;
+    unsigned repeat = 5;
+    double generate = 0;
+    uint32_t seed = 1;
+    double min_mtokens = 0;
+    double min_mib = 0;
+    bool all_tokens = false;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()("repeat,r", po::value<unsigned>(&repeat),
+                       "number of timed runs, the best one is reported")(
+        "generate,g", po::value<double>(&generate),
+        "lex a synthetic document of the given size in MiB instead of a file")(
+        "seed,s", po::value<uint32_t>(&seed), "seed of the synthetic document")(
+        "min-mtokens", po::value<double>(&min_mtokens),
+        "fail if fewer million tokens per second are lexed")(
+        "min-mib", po::value<double>(&min_mib), "fail if fewer MiB per second are lexed")(
+        "all-tokens", po::bool_switch(&all_tokens),
+        "fail if the document does not contain every token type")(
+        "input", po::value<std::string>(&input_file), "input file")("help,h", "show help message");
+
+    po::positional_options_description pos_desc;
+    pos_desc.add("input", 1);
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos_desc).run(), vm);
+        po::notify(vm);
+    } catch (const std::exception &e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const bool has_input = !input_file.empty() || generate > 0;
+    if (vm.count("help") || !has_input || repeat == 0) {
+        std::cout << "usage: bench_lexer [options] [input]" << std::endl << desc << std::endl;
+        return vm.count("help") ? 0 : 1;
+    }
+
+    // the document is loaded once, only tokenization is timed
+    std::shared_ptr<const SourceBuffer> source;
+    std::string name = input_file;
+    if (generate > 0) {
+        std::istringstream document(
+            SourceGenerator(seed).generate(static_cast<size_t>(generate * (1 << 20))));
+        source = SourceBuffer::from_stream(document);
+        name = "synthetic(seed " + std::to_string(seed) + ")";
+    } else {
+        source = SourceBuffer::from_file(input_file);
+    }
+
+    LexRun best;
+    for (unsigned i = 0; i < repeat; ++i) {
+        LexRun run;
+        try {
+            run = lex_once(source);
+        } catch (CompilerException &e) {
+            std::cerr << e.what() << " at " << e.get_position() << std::endl;
+            return 1;
+        }
+        if (i == 0 || run.seconds < best.seconds) best = run;
+    }
+
+    size_t producible = 0;
+    size_t seen = 0;
+    for (size_t type = 0; type < token_types; ++type) {
+        if (!is_producible(static_cast<TokenType>(type))) continue;
+        producible++;
+        if (best.counts[type]) seen++;
+    }
+
+    const double megabytes = static_cast<double>(source->size()) / (1 << 20);
+    const double mtokens_per_second = best.tokens / best.seconds / 1e6;
+    const double mib_per_second = megabytes / best.seconds;
+    std::cout << std::fixed << std::setprecision(3) << name << ": " << source->size()
+              << " bytes, " << best.tokens << " tokens, " << seen << "/" << producible
+              << " token types, best of " << repeat << ": " << best.seconds << " s, "
+              << mtokens_per_second << " Mtokens/s, " << mib_per_second << " MiB/s" << std::endl;
+
+    int status = 0;
+    if (all_tokens && seen != producible) {
+        for (size_t type = 0; type < token_types; ++type) {
+            if (is_producible(static_cast<TokenType>(type)) && !best.counts[type]) {
+                std::cerr << "missing token type " << static_cast<TokenType>(type) << std::endl;
+            }
+        }
+        status = 2;
+    }
+    if (mtokens_per_second < min_mtokens || mib_per_second < min_mib) {
+        std::cerr << "throughput below the required minimum" << std::endl;
+        status = 2;
+    }
+    return status;
+}
@@ -0,0 +1,44 @@
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+
+#include "source_generator.h"
+
+namespace po = boost::program_options;
+
+auto main(int argc, char **argv) -> int {
+    std::string output_file;
+    double size = 1;
+    uint32_t seed = 1;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()("size,S", po::value<double>(&size), "size of the document in MiB")(
+        "seed,s", po::value<uint32_t>(&seed), "seed of the document")(
+        "output", po::value<std::string>(&output_file), "output file, standard output if omitted")(
+        "help,h", "show help message");
+
+    po::positional_options_description pos_desc;
+    pos_desc.add("output", 1);
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos_desc).run(), vm);
+        po::notify(vm);
+    } catch (const std::exception &e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help")) {
+        std::cout << "usage: generate_source [options] [output]" << std::endl << desc << std::endl;
+        return 0;
+    }
+
+    const std::string document = SourceGenerator(seed).generate(static_cast<size_t>(size * (1 << 20)));
+    if (output_file.empty()) {
+        std::cout << document;
+    } else {
+        std::ofstream(output_file, std::ios::binary) << document;
+    }
+    return 0;
+}
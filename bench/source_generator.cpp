@@ -0,0 +1,239 @@
+#include "source_generator.h"
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+static constexpr std::array<std::string_view, 12> names{
+    "a", "b", "count", "delta", "value", "acc", "total", "x1", "y_2", "result", "item", "step"};
+static constexpr std::array<std::string_view, 4> basic_types{"int", "flt", "string", "bool"};
+static constexpr std::array<std::string_view, 8> arithmetic_ops{" + ",  " - ", " * ",  " / ",
+                                                                 " < ",  " > ", " <= ", " >= "};
+static constexpr std::array<std::string_view, 4> logic_ops{" && ", " || ", " == ", " != "};
+static constexpr std::array<std::string_view, 6> words{
+    "Result: ",
+    "value of ",
+    "LOG: ",
+    "",
+    "a longer string literal, the kind found in messages printed by a program",
+    "tab\\tand newline\\n"};
+
+SourceGenerator::SourceGenerator(uint32_t seed) : random(seed) {}
+
+auto SourceGenerator::pick(uint32_t bound) -> uint32_t { return random() % bound; }
+
+auto SourceGenerator::line() -> std::string & {
+    out += '\n';
+    out.append(indent * 4, ' ');
+    return out;
+}
+
+void SourceGenerator::identifier() {
+    out += names[pick(names.size())];
+    if (pick(4) == 0) out += std::to_string(pick(100));
+}
+
+void SourceGenerator::type() {
+    if (pick(8)) {
+        out += basic_types[pick(basic_types.size())];
+        return;
+    }
+    out += '[';
+    out += pick(2) ? "int" : "void";
+    out += "::";
+    const uint32_t params = 1 + pick(3);
+    for (uint32_t i = 0; i < params; ++i) {
+        if (i) out += ", ";
+        if (pick(2)) out += "mut ";
+        out += basic_types[pick(basic_types.size())];
+    }
+    out += ']';
+}
+
+void SourceGenerator::literal() {
+    switch (pick(4)) {
+        case 0:
+            out += std::to_string(pick(100000));
+            break;
+        case 1:
+            out += std::to_string(pick(1000));
+            out += '.';
+            out += std::to_string(pick(100));
+            break;
+        case 2:
+            out += '"';
+            out += words[pick(words.size())];
+            out += '"';
+            break;
+        default:
+            out += pick(2) ? "true" : "false";
+    }
+}
+
+void SourceGenerator::expression(unsigned depth) {
+    switch (pick(depth ? 7 : 3)) {
+        case 0:
+            identifier();
+            break;
+        case 1:
+            literal();
+            break;
+        case 2:
+            out += pick(2) ? '-' : '!';
+            identifier();
+            break;
+        case 3:
+            out += '(';
+            expression(depth - 1);
+            out += ')';
+            break;
+        case 4:
+            out += '(';
+            expression(depth - 1);
+            out += ") -> ";
+            identifier();
+            break;
+        default:
+            expression(depth - 1);
+            out += arithmetic_ops[pick(arithmetic_ops.size())];
+            expression(depth - 1);
+    }
+}
+
+void SourceGenerator::condition() {
+    expression(2);
+    out += logic_ops[pick(logic_ops.size())];
+    expression(2);
+}
+
+void SourceGenerator::statement(unsigned depth) {
+    line();
+    switch (pick(depth ? 9 : 5)) {
+        case 0:
+            expression(3);
+            out += " => ";
+            if (pick(2)) out += "mut ";
+            type();
+            out += ' ';
+            identifier();
+            out += ';';
+            break;
+        case 1:
+            out += '(';
+            expression(2);
+            for (uint32_t args = pick(3); args; --args) {
+                out += ", ";
+                expression(1);
+            }
+            out += ") -> ";
+            identifier();
+            if (pick(3) == 0) {
+                out += " @ ";
+                identifier();
+            }
+            out += ';';
+            break;
+        case 2:
+            out += '(';
+            if (pick(2)) {
+                out += '_';
+            } else {
+                expression(1);
+            }
+            out += ", ";
+            expression(1);
+            out += ") ->> ";
+            identifier();
+            out += " => ";
+            type();
+            out += ' ';
+            identifier();
+            out += ';';
+            break;
+        case 3:
+            out += "ret ";
+            expression(2);
+            out += ';';
+            if (pick(2)) {
+                out += " // ";
+                out += words[pick(words.size())];
+            }
+            break;
+        case 4:
+            out += "// ";
+            out += words[pick(words.size())];
+            break;
+        case 5:
+            out += "if (";
+            condition();
+            out += ") ";
+            block(depth - 1);
+            if (pick(2)) {
+                out += " elif (";
+                condition();
+                out += ") ";
+                block(depth - 1);
+            }
+            if (pick(2)) {
+                out += " else ";
+                block(depth - 1);
+            }
+            break;
+        case 6:
+            out += "while (";
+            condition();
+            out += ") ";
+            block(depth - 1);
+            break;
+        default:
+            out += "for (0 => mut int ";
+            identifier();
+            out += "; ";
+            condition();
+            out += ") ";
+            block(depth - 1);
+            out += " -> increment @ ";
+            identifier();
+            out += ';';
+    }
+}
+
+void SourceGenerator::block(unsigned depth) {
+    out += '{';
+    ++indent;
+    for (uint32_t statements = 1 + pick(4); statements; --statements) statement(depth);
+    --indent;
+    line();
+    out += '}';
+}
+
+void SourceGenerator::function() {
+    out += '\n';
+    if (pick(6) == 0) {
+        out += "void";
+    } else {
+        type();
+    }
+    out += " f_";
+    out += std::to_string(functions++);
+    if (pick(4)) {
+        out += " :: ";
+        const uint32_t params = 1 + pick(3);
+        for (uint32_t i = 0; i < params; ++i) {
+            if (i) out += ", ";
+            if (pick(2)) out += "mut ";
+            type();
+            out += ' ';
+            identifier();
+        }
+    }
+    out += ' ';
+    block(3);
+    out += '\n';
+}
+
+auto SourceGenerator::generate(size_t size) -> std::string {
+    out = "// synthetic source, generated for benchmarking\n";
+    while (out.size() < size) function();
+    return std::exchange(out, {});
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+/**
+ * @brief deterministic generator of large synthetic tkom sources
+ *
+ * The output is shaped like real programs (functions with declarations, loops, conditionals,
+ * calls, bindings and decorators) and contains every token type the lexer can produce. It is only
+ * guaranteed to be lexically valid, not to parse or run. The same seed and size always produce the
+ * same document, on every platform.
+ */
+class SourceGenerator {
+   private:
+    std::mt19937 random;  //< the source of randomness, distributions are avoided for portability
+    std::string out;  //< the document generated so far
+    unsigned indent = 0;  //< the current nesting depth
+    unsigned functions = 0;  //< the number of functions generated so far
+
+    /**
+     * @brief get a pseudo-random number from `[0, bound)`
+     */
+    auto pick(uint32_t bound) -> uint32_t;
+
+    auto line() -> std::string &;
+    void identifier();
+    void type();
+    void literal();
+    void expression(unsigned depth);
+    void condition();
+    void statement(unsigned depth);
+    void block(unsigned depth);
+    void function();
+
+   public:
+    explicit SourceGenerator(uint32_t seed = 1);
+
+    /**
+     * @brief generate whole functions until the document is at least `size` bytes long
+     */
+    auto generate(size_t size) -> std::string;
+};
@@ -0,0 +1,126 @@
+#pragma once
+/**
+ * @file arena.h
+ *
+ * Bump allocator for syntax tree nodes
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @brief bump allocator handing out memory from large contiguous chunks
+ *
+ * Memory is never returned to the arena piecemeal, all of it is released at once when the arena
+ * is destroyed. Objects placed in the arena must not outlive it.
+ */
+class Arena {
+   private:
+    static constexpr size_t chunk_size = 64 * 1024;  //< default size of a single chunk
+
+    /**
+     * @brief a single contiguous block of memory
+     */
+    struct Chunk {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;  //< all chunks owned by the arena, in allocation order
+    std::byte *next = nullptr;  //< first free byte of the last chunk
+    std::byte *end = nullptr;   //< end of the last chunk
+    size_t used = 0;            //< bytes handed out so far
+
+    static inline thread_local Arena *active = nullptr;  //< arena serving node allocations
+
+    static auto align_up(std::byte *ptr, size_t align) -> std::byte * {
+        const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+        return ptr + ((align - addr % align) % align);
+    }
+
+   public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    auto operator=(const Arena &) -> Arena & = delete;
+
+    /**
+     * @brief allocate `size` bytes aligned to `align`, which must be a power of two
+     */
+    auto allocate(size_t size, size_t align = alignof(std::max_align_t)) -> void * {
+        std::byte *aligned = next ? align_up(next, align) : nullptr;
+        if (!aligned || size > static_cast<size_t>(end - aligned)) {
+            const size_t capacity = std::max(chunk_size, size + align);
+            auto &chunk = chunks.emplace_back(
+                Chunk{std::make_unique_for_overwrite<std::byte[]>(capacity), capacity});
+            end = chunk.memory.get() + capacity;
+            aligned = align_up(chunk.memory.get(), align);
+        }
+        next = aligned + size;
+        used += size;
+        return aligned;
+    }
+
+    /**
+     * @brief check whether a pointer points into memory owned by the arena
+     */
+    [[nodiscard]] auto contains(const void *ptr) const -> bool {
+        const auto *byte = static_cast<const std::byte *>(ptr);
+        return std::ranges::any_of(chunks, [byte](const Chunk &chunk) {
+            return byte >= chunk.memory.get() && byte < chunk.memory.get() + chunk.size;
+        });
+    }
+
+    /**
+     * @brief get the number of bytes handed out so far
+     */
+    [[nodiscard]] auto get_used() const -> size_t { return used; }
+
+    /**
+     * @brief get the arena currently serving node allocations on this thread, if any
+     */
+    static auto current() -> Arena * { return active; }
+
+    /**
+     * @brief makes an arena serve node allocations on this thread for the scope's lifetime
+     */
+    class Scope {
+       private:
+        Arena *previous;  //< the arena active before the scope
+
+       public:
+        explicit Scope(Arena &arena) : previous(active) { active = &arena; }
+        ~Scope() { active = previous; }
+        Scope(const Scope &) = delete;
+        auto operator=(const Scope &) -> Scope & = delete;
+    };
+};
+
+/**
+ * @brief base for classes whose instances are placed in the active arena when there is one
+ *
+ * Instances created while no arena is active (such as types cloned at run time) come from the
+ * global heap. Every allocation is prefixed with a header telling `operator delete` whether the
+ * memory has to be freed, arena memory is only released together with its arena.
+ */
+struct ArenaAllocated {
+   private:
+    static constexpr size_t header = alignof(std::max_align_t);  //< size of the ownership header
+
+   public:
+    /**
+     * @brief allocate an instance of `size` bytes, from the heap if no arena is active
+     */
+    static auto operator new(size_t size) -> void *;
+
+    /**
+     * @brief free an instance of `size` bytes, unless it was placed in an arena
+     *
+     * Defined out of line, so the compiler pairs it with `operator new` above rather than with
+     * the heap functions both of them wrap.
+     */
+    static void operator delete(void *ptr, size_t size) noexcept;
+};
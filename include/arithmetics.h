@@ -1,6 +1,7 @@
 #pragma once
 #include "exceptions.h"
 #include "interpreter_helpers.h"
+#include "overload.h"
 
 /**
  * @brief function for promoting types to string for the purpose of weak-type arithmetics
@@ -39,18 +40,6 @@ auto get_val_for_arithmetic(const ValType& l, const ValType& r, OpFunc func) ->
         l, r);
 }
 
-/**
- * @brief overload template for expression parsing
- *
- * Inspired by: https://www.modernescpp.com/index.php/smart-tricks-with-fold-expressions/
- */
-template <typename... Ts>
-struct Overload : Ts... {
-    using Ts::operator()...;
-};
-template <class... Ts>
-Overload(Ts...) -> Overload<Ts...>;
-
 /**
  * @brief struct for handling the '+' operator
  */
@@ -156,7 +145,28 @@ struct Decorate {
         -> ValType {
         ArgVector args;
         args.emplace_back(ValType{l});
-        return std::make_shared<LocalFunction>(r, args);
+        return std::make_shared<LocalFunction>(r, std::move(args));
     }
     auto operator()(auto, auto) -> ValType { throw InterpreterError("Unsupported operator: '@'"); }
 };
+
+/**
+ * @brief evaluate a binary operator for two already evaluated operands
+ *
+ * Shared by every engine, so that all of them follow the same weak-typing rules
+ */
+auto apply_binary_op(BinaryOp op, const ValType& left, const ValType& right) -> ValType;
+
+/**
+ * @brief evaluate a binary operator for two operands statically known to be of the given type
+ *
+ * Uses a monomorphic kernel for integer, float and string operands, other operators and types
+ * fall back to `apply_binary_op`
+ */
+auto apply_typed_binary_op(BaseType type, BinaryOp op, const ValType& left, const ValType& right)
+    -> ValType;
+
+/**
+ * @brief evaluate an unary operator for an already evaluated operand
+ */
+auto apply_unary_op(UnaryOp op, const ValType& right) -> ValType;
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "node.h"
+#include "node_view.h"
 #include "statement.h"
 
 class ParserPrinter;
@@ -23,7 +24,9 @@ class Block : public Node {
     void accept(Visitor &visitor) const;
 
     /**
-     * @brief get the block's body as a vector of const Statement*
+     * @brief get the block's body as a view of const Statement*
      */
-    [[nodiscard]] auto get_statements() const -> std::vector<const Statement *>;
+    [[nodiscard]] auto get_statements() const -> NodeView<Statement> {
+        return node_view(statements);
+    }
 };
@@ -2,19 +2,13 @@
 #include <functional>
 #include <utility>
 
-#include "interpreter.h"
+#include "engine.h"
 #include "interpreter_shall.h"
 #include "local_function.h"
+#include "overload.h"
 #include "type.h"
 #include "type_cast.h"
 
-template <typename... Ts>
-struct Overload : Ts... {
-    using Ts::operator()...;
-};
-template <class... Ts>
-Overload(Ts...) -> Overload<Ts...>;
-
 /**
  * @brief the function to be called
  *
@@ -37,13 +31,12 @@ class BuiltIn : public Callable {
 
     /**
      * @brief call the builtin function
-     * @param interpreter the interpreter to be used for type-checking
-     * @param params the function's parameters as an `ArgVector`
+     * @param engine the engine to be used for type-checking
+     * @param args the function's arguments as an `ArgVector`, cast in place
      */
-    void call(InterpreterVisitor& interpreter, ArgVector params) override {
-        check_types(interpreter, params);
-        auto retval = func(params);
-        interpreter.override_value(retval);
+    void call(Engine& engine, ArgVector& args) override {
+        check_types(args);
+        engine.override_value(func(args));
     }
 
     /**
@@ -64,30 +57,23 @@ class BuiltIn : public Callable {
     /**
      * @brief check the function's argument types
      *
-     * This method checks for type equality when dealing with references, and creates
-     * temporary variables for values, attempting to type cast them if needed
+     * This method checks for type equality when dealing with references, and attempts to
+     * type cast values in place if needed
      *
-     * @param interpreter the interpreter to be used for variable initializing
      * @param args function's argument vector
      */
-    auto check_types(InterpreterVisitor& interpreter, ArgVector& args) const
-        -> std::vector<std::shared_ptr<VarRef>> {
+    void check_types(ArgVector& args) const {
         const auto expected = type->get_params();
         shall(expected.size() == args.size(), "Incorrect number of arguments");
-        std::vector<std::shared_ptr<VarRef>> var_refs;
         for (size_t i = 0; i < expected.size(); ++i) {
             auto expected_arg = expected[i];
             std::visit(
-                Overload{[&](std::shared_ptr<Variable> var) {
+                Overload{[&](Variable* var) {
                              shall(expected_arg->is_equal_to(var->get_type()),
                                    "Type-mismatched reference. Did you want to pass by value?");
                          },
-                         [&](ValType& value) {
-                             auto type = expected[i];
-                             value = std::visit(TypeCast(), value, interpreter.init_var(*type));
-                         }},
+                         [&](ValType& value) { value = cast_value(value, *expected_arg); }},
                 args[i]);
         }
-        return var_refs;
     }
 };
@@ -0,0 +1,122 @@
+#pragma once
+/**
+ * @file bytecode.h
+ *
+ * Definitions of the register-based bytecode executed by the `VirtualMachine`
+ */
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "interpreter_helpers.h"
+
+/**
+ * @brief operation codes of the virtual machine
+ *
+ * Operands are named after the `Instruction` fields they are stored in. `R[x]` is a register of
+ * the current frame, `L[x]` a local variable slot and `K[x]` a constant of the chunk.
+ * The order of the entries must match the dispatch table in `vm.cpp`.
+ */
+enum class OpCode : uint8_t {
+    LOAD_CONST,     //< R[a] = K[b]
+    LOAD_LOCAL,     //< R[a] = L[b].value
+    DECLARE,        //< L[a] = new variable of declaration b, initialized with R[c]
+    STORE,          //< L[a].value = R[b], cast to the variable's type
+    ADD,            //< R[a] = R[b] + R[c]
+    SUB,            //< R[a] = R[b] - R[c]
+    MULT,           //< R[a] = R[b] * R[c]
+    DIV,            //< R[a] = R[b] / R[c]
+    LT,             //< R[a] = R[b] < R[c]
+    LTE,            //< R[a] = R[b] <= R[c]
+    GT,             //< R[a] = R[b] > R[c]
+    GTE,            //< R[a] = R[b] >= R[c]
+    EQ,             //< R[a] = R[b] == R[c]
+    NEQ,            //< R[a] = R[b] != R[c]
+    AND,            //< R[a] = R[b] && R[c]
+    OR,             //< R[a] = R[b] || R[c]
+    DECORATE,       //< R[a] = R[b] @ R[c]
+    NOT,            //< R[a] = !R[b]
+    NEG,            //< R[a] = -R[b]
+    ADD_INT,        //< R[a] = R[b] + R[c], both integers
+    SUB_INT,        //< R[a] = R[b] - R[c], both integers
+    MULT_INT,       //< R[a] = R[b] * R[c], both integers
+    LT_INT,         //< R[a] = R[b] < R[c], both integers
+    LTE_INT,        //< R[a] = R[b] <= R[c], both integers
+    GT_INT,         //< R[a] = R[b] > R[c], both integers
+    GTE_INT,        //< R[a] = R[b] >= R[c], both integers
+    EQ_INT,         //< R[a] = R[b] == R[c], both integers
+    NEQ_INT,        //< R[a] = R[b] != R[c], both integers
+    ADD_FLT,        //< R[a] = R[b] + R[c], both floats
+    SUB_FLT,        //< R[a] = R[b] - R[c], both floats
+    MULT_FLT,       //< R[a] = R[b] * R[c], both floats
+    LT_FLT,         //< R[a] = R[b] < R[c], both floats
+    LTE_FLT,        //< R[a] = R[b] <= R[c], both floats
+    GT_FLT,         //< R[a] = R[b] > R[c], both floats
+    GTE_FLT,        //< R[a] = R[b] >= R[c], both floats
+    EQ_FLT,         //< R[a] = R[b] == R[c], both floats
+    NEQ_FLT,        //< R[a] = R[b] != R[c], both floats
+    JUMP,           //< jump to instruction a
+    JUMP_IF_FALSE,  //< jump to instruction b if R[a] cast to bool is false
+    CALL,           //< R[a] = R[b](arguments of call site c)
+    TAIL_CALL,      //< return R[b](arguments of call site c), reusing the frame when possible
+    BIND,           //< R[a] = R[b] bound with the arguments of call site c
+    EXPECT_FUNC,    //< throw K[b] if R[a] is not a function
+    RET,            //< return R[a]
+    RET_DEFAULT,    //< return the default value of the function's return type
+    THROW,          //< throw an interpreter error with the message K[a]
+};
+
+auto operator<<(std::ostream &os, OpCode op) -> std::ostream &;
+
+/**
+ * @brief a single instruction of the virtual machine
+ */
+struct Instruction {
+    OpCode op;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
+};
+
+/**
+ * @brief a single argument of a call site - a register (by value) or a local slot (by reference)
+ */
+struct ArgSource {
+    bool by_ref;     //< whether the argument is a local variable passed by reference
+    uint32_t index;  //< register or local slot index
+};
+
+/**
+ * @brief arguments of a `CALL` or `BIND` instruction
+ */
+struct CallSite {
+    std::vector<ArgSource> args;
+};
+
+/**
+ * @brief a variable declaration executed by the `DECLARE` instruction
+ */
+struct Declaration {
+    const VariableSignature *signature;  //< the declared variable
+    ValType init;                        //< default value of the variable's type, used for casting
+};
+
+/**
+ * @brief the compiled form of a single function
+ */
+struct Chunk {
+    std::string name;                       //< name of the compiled function
+    std::vector<Instruction> code;          //< instructions
+    std::vector<Position> positions;        //< source position of each instruction
+    std::vector<ValType> constants;         //< constant pool
+    std::vector<CallSite> call_sites;       //< argument lists of calls and bind fronts
+    std::vector<Declaration> declarations;  //< variable declarations
+    ValType ret_default;                    //< value returned when the function has no `ret`
+    const Type *ret_type = nullptr;         //< the function's return type
+    uint32_t params = 0;                    //< number of parameters, stored in the first locals
+    uint32_t locals = 0;                    //< number of local variable slots
+    uint32_t registers = 0;                 //< number of registers
+
+    friend auto operator<<(std::ostream &os, const Chunk &chunk) -> std::ostream &;
+};
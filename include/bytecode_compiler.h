@@ -0,0 +1,134 @@
+#pragma once
+
+#include <functional>
+
+#include "bytecode.h"
+#include "symbol.h"
+#include "visitor.h"
+
+/**
+ * @brief Compiler lowering a single parsed function into VM bytecode
+ *
+ * The compiler walks the function's syntax tree once and produces a `Chunk`:
+ *      - local variables are resolved to slot indices at compile time
+ *      - expression temporaries are allocated in registers, released after each statement
+ *      - global functions are resolved to constants
+ *
+ * Errors that the tree-walking interpreter reports at runtime (unknown identifiers,
+ * re-definitions, assignments to immutable variables) are compiled into `THROW` instructions,
+ * so they are still raised only if the offending statement is executed.
+ */
+class BytecodeCompiler : public Visitor {
+   public:
+    /**
+     * @brief function used to resolve global function names
+     */
+    using FunctionLookup = std::function<std::shared_ptr<Callable>(Symbol)>;
+
+   private:
+    /**
+     * @brief a local variable visible during compilation
+     */
+    struct LocalVar {
+        Symbol name;                           //< the variable's name
+        uint32_t slot;                         //< the variable's slot in the frame
+        const VariableSignature *signature;  //< the variable's declaration
+    };
+
+    FunctionLookup find_func;            //< global function resolver
+    std::unique_ptr<Chunk> chunk;        //< the chunk being built
+    std::vector<std::vector<LocalVar>> scopes;  //< block scopes, the first one holds parameters
+    Position position;                   //< source position attributed to emitted instructions
+    uint32_t result = 0;                 //< register holding the last compiled expression
+    uint32_t next_reg = 0;               //< first free register
+
+    auto emit(OpCode op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) -> uint32_t;
+    auto add_constant(ValType value) -> uint32_t;
+    auto alloc_reg() -> uint32_t;
+
+    /**
+     * @brief point the jump instruction at `jump` to the next emitted instruction
+     */
+    void patch_jump(uint32_t jump);
+
+    /**
+     * @brief emit an instruction throwing an interpreter error with the given message
+     */
+    void emit_throw(const std::string &message);
+
+    /**
+     * @brief load a literal or folded constant into a fresh register
+     */
+    void load_literal(const ValueType &value);
+
+    /**
+     * @brief find a visible local variable by its name
+     */
+    auto find_local(Symbol name) const -> const LocalVar *;
+
+    /**
+     * @brief compile a node, attributing its position to the emitted instructions
+     *
+     * Mirrors `InterpreterVisitor::try_visit`, so that errors point at the same node
+     */
+    template <typename T>
+    void track(T node) {
+        const Position saved = position;
+        position = node->get_position();
+        node->accept(*this);
+        position = saved;
+    }
+
+    /**
+     * @brief compile an expression and return the register holding its value
+     */
+    auto compile_expr(const Expression *expr) -> uint32_t;
+
+   public:
+    BytecodeCompiler(FunctionLookup find_func);
+
+    /**
+     * @brief compile a single function
+     */
+    auto compile(const Function &func) -> std::unique_ptr<Chunk>;
+
+    void visit(const Program &program) override {
+        (void)program;
+        return;
+    }
+
+    void visit(const LiteralExpr &expr) override;
+    void visit(const IdentifierExpr &expr) override;
+    void visit(const UnaryExpr &expr) override;
+    void visit(const BinaryExpr &expr) override;
+    void visit(const CallExpr &expr) override;
+    void visit(const BindFrtExpr &expr) override;
+
+    void visit(const ForLoopStatement &stmt) override;
+    void visit(const WhileLoopStatement &stmt) override;
+    void visit(const ConditionalStatement &stmt) override;
+    void visit(const ElseStatement &stmt) override;
+    void visit(const RetStatement &stmt) override;
+    void visit(const CallStatement &stmt) override;
+    void visit(const AssignStatement &stmt) override;
+
+    void visit(const Block &block) override;
+    void visit(const VarType &type) override {
+        (void)type;
+        return;
+    }
+    void visit(const FuncType &type) override {
+        (void)type;
+        return;
+    }
+
+    void visit(const VariableSignature &var) override {
+        (void)var;
+        return;
+    }
+    void visit(const FuncSignature &sign) override {
+        (void)sign;
+        return;
+    }
+    void visit(const Function &func) override;
+};
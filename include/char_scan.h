@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief helpers finding the end of a run of characters in the source document
+ *
+ * Each scanner returns a pointer to the first character in `[begin, end)` that does not belong to
+ * the run, or `end` if the whole range does. With SSE2 available, the range is examined 16 bytes
+ * at a time, the tail is always examined byte by byte.
+ */
+inline auto is_identifier_char(char c) -> bool {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+inline auto is_blank(char c) -> bool { return c == ' ' || c == '\t'; }
+
+inline auto is_string_char(char c) -> bool {
+    return c != '"' && c != '\\' && c != '\n' && c != '\r';
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief get the offset of the first unset bit of a 16-bit membership mask, 16 if all are set
+ */
+inline auto simd_first_miss(__m128i members) -> int {
+    const int misses = ~_mm_movemask_epi8(members) & 0xffff;
+    return misses ? __builtin_ctz(misses) : 16;
+}
+
+inline auto simd_in_range(__m128i chars, char low, char high) -> __m128i {
+    return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(static_cast<char>(low - 1))),
+                         _mm_cmplt_epi8(chars, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+#endif
+
+/**
+ * @brief skip letters, digits and '_'
+ */
+inline auto scan_identifier(const char *begin, const char *end) -> const char * {
+#if defined(__SSE2__)
+    for (; end - begin >= 16; begin += 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        const __m128i letters = simd_in_range(lower, 'a', 'z');
+        const __m128i digits = simd_in_range(chars, '0', '9');
+        const __m128i members =
+            _mm_or_si128(_mm_or_si128(letters, digits), _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+        const int miss = simd_first_miss(members);
+        if (miss != 16) return begin + miss;
+    }
+#endif
+    while (begin != end && is_identifier_char(*begin)) ++begin;
+    return begin;
+}
+
+/**
+ * @brief skip spaces and tabs, line breaks end the run
+ */
+inline auto scan_blanks(const char *begin, const char *end) -> const char * {
+#if defined(__SSE2__)
+    for (; end - begin >= 16; begin += 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const __m128i members = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+                                             _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t')));
+        const int miss = simd_first_miss(members);
+        if (miss != 16) return begin + miss;
+    }
+#endif
+    while (begin != end && is_blank(*begin)) ++begin;
+    return begin;
+}
+
+/**
+ * @brief skip the body of a string literal, up to a quote, an escape or a line break
+ */
+inline auto scan_string_body(const char *begin, const char *end) -> const char * {
+#if defined(__SSE2__)
+    for (; end - begin >= 16; begin += 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const __m128i stops =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('"')),
+                                      _mm_cmpeq_epi8(chars, _mm_set1_epi8('\\'))),
+                         _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')),
+                                      _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r'))));
+        const int stop = _mm_movemask_epi8(stops);
+        if (stop) return begin + __builtin_ctz(stop);
+    }
+#endif
+    while (begin != end && is_string_char(*begin)) ++begin;
+    return begin;
+}
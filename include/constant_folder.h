@@ -0,0 +1,65 @@
+#pragma once
+
+#include <optional>
+
+#include "interpreter_helpers.h"
+#include "visitor.h"
+
+/**
+ * @brief Optimization pass precomputing constant expressions
+ *
+ * The folder walks the whole program once, after parsing and before execution, and annotates
+ * each `BinaryExpr` and `UnaryExpr` whose operands are all literals (or constant expressions
+ * themselves) with its value. Engines use the annotation instead of evaluating the expression.
+ *
+ * Values are computed with `apply_binary_op`/`apply_unary_op`, so folded programs behave exactly
+ * like unfolded ones. Expressions which would fail (e.g. `"a" - 1`) or divide an integer by zero
+ * are left alone, the engines report them when - and if - they are executed.
+ */
+class ConstantFolder : public Visitor {
+   private:
+    std::optional<ValType> constant;  //< value of the last visited expression, if constant
+
+    /**
+     * @brief visit an expression and return its value, if it is constant
+     */
+    auto fold(const Expression *expr) -> std::optional<ValType>;
+
+   public:
+    void visit(const Program &program) override;
+
+    void visit(const LiteralExpr &expr) override;
+    void visit(const IdentifierExpr &expr) override;
+    void visit(const UnaryExpr &expr) override;
+    void visit(const BinaryExpr &expr) override;
+    void visit(const CallExpr &expr) override;
+    void visit(const BindFrtExpr &expr) override;
+
+    void visit(const ForLoopStatement &stmt) override;
+    void visit(const WhileLoopStatement &stmt) override;
+    void visit(const ConditionalStatement &stmt) override;
+    void visit(const ElseStatement &stmt) override;
+    void visit(const RetStatement &stmt) override;
+    void visit(const CallStatement &stmt) override;
+    void visit(const AssignStatement &stmt) override;
+
+    void visit(const Block &block) override;
+    void visit(const VarType &type) override {
+        (void)type;
+        return;
+    }
+    void visit(const FuncType &type) override {
+        (void)type;
+        return;
+    }
+
+    void visit(const VariableSignature &var) override {
+        (void)var;
+        return;
+    }
+    void visit(const FuncSignature &sign) override {
+        (void)sign;
+        return;
+    }
+    void visit(const Function &func) override;
+};
@@ -0,0 +1,49 @@
+#pragma once
+/**
+ * @file engine.h
+ *
+ * Interface shared by all execution engines (the tree-walking interpreter and the bytecode VM)
+ */
+
+#include "interpreter_helpers.h"
+
+/**
+ * @brief abstract execution engine
+ *
+ * Callables (global, local and builtin functions) only communicate with the engine that invoked
+ * them through this interface, which allows both engines to share the same function objects.
+ */
+class Engine {
+   public:
+    virtual ~Engine() = default;
+
+    /**
+     * @brief return the current value
+     */
+    [[nodiscard]] virtual auto get_value() const -> ValType = 0;
+
+    /**
+     * @brief override the current value
+     */
+    virtual void override_value(ValType val) = 0;
+
+    /**
+     * @brief initialize a variable with a given type
+     */
+    virtual auto init_var(const Type &type) -> ValType = 0;
+
+    /**
+     * @brief execute the body of a user-defined function
+     *
+     * The arguments are already type-checked and cast to the function's parameter types, the
+     * engine binds them to the parameters in its own frame layout - references directly, values
+     * as variables of the new frame. After the call the function's return value is available
+     * through `get_value()`.
+     */
+    virtual void run_function(const Function &func, ArgVector &args) = 0;
+
+    /**
+     * @brief bind the identifiers of a function whose body was parsed on its first call
+     */
+    virtual void resolve(const Function &func) = 0;
+};
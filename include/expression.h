@@ -10,14 +10,19 @@
  */
 
 #include <memory>
+#include <optional>
 #include <variant>
 #include <vector>
 
 #include "node.h"
+#include "node_view.h"
 #include "operators.h"
+#include "symbol.h"
 #include "token.h"
+#include "var_slot.h"
 
 enum class BaseType;
+class Callable;
 class Visitor;
 
 /**
@@ -55,7 +60,9 @@ class LiteralExpr : public Expression {
     [[nodiscard]] auto get_value() const -> ValueType { return value; }
 
     LiteralExpr(const Position pos, Token token);
+    LiteralExpr(const Position pos, BaseType type, ValueType value);
     void accept(Visitor &visitor) const override;
+    [[nodiscard]] auto get_type() const -> BaseType { return type; }
     [[nodiscard]] auto get_value_string() const -> std::string;
 };
 
@@ -64,13 +71,28 @@ class LiteralExpr : public Expression {
  */
 class IdentifierExpr : public Expression {
    private:
-    std::string identifier;
+    Symbol identifier;
+    mutable std::optional<VarSlot> slot;  //< local variable slot, filled in by the resolver
+    mutable std::shared_ptr<Callable> function;  //< bound global function, filled in by the resolver
 
    public:
-    IdentifierExpr(const Position pos, std::string identifier);
+    IdentifierExpr(const Position pos, Symbol identifier);
 
     void accept(Visitor &visitor) const override;
-    [[nodiscard]] auto get_identifier() const -> std::string;
+    [[nodiscard]] auto get_identifier() const -> const std::string & { return identifier.str(); }
+    [[nodiscard]] auto get_symbol() const -> Symbol { return identifier; }
+
+    /**
+     * @brief get the resolved slot, empty if the identifier is not a local variable
+     */
+    [[nodiscard]] auto get_slot() const -> std::optional<VarSlot> { return slot; }
+    void set_slot(std::optional<VarSlot> resolved) const { slot = resolved; }
+
+    /**
+     * @brief get the global function the identifier was bound to, nullptr if it was not bound
+     */
+    [[nodiscard]] auto get_function() const -> std::shared_ptr<Callable> { return function; }
+    void set_function(std::shared_ptr<Callable> bound) const { function = std::move(bound); }
 };
 
 /**
@@ -83,6 +105,7 @@ class UnaryExpr : public Expression {
    private:
     UnaryOp op_type;
     std::unique_ptr<Expression> right;
+    mutable std::optional<ValueType> folded;  //< value of a constant expression, if folded
 
    public:
     UnaryExpr(const Position pos, UnaryOp unary_op, std::unique_ptr<Expression> right);
@@ -90,6 +113,12 @@ class UnaryExpr : public Expression {
     void accept(Visitor &visitor) const override;
 
     [[nodiscard]] auto get_right() const -> const Expression *;
+
+    /**
+     * @brief get the precomputed value of the expression, filled in by the constant folder
+     */
+    [[nodiscard]] auto get_folded() const -> const std::optional<ValueType> & { return folded; }
+    void set_folded(std::optional<ValueType> value) const { folded = std::move(value); }
 };
 
 /**
@@ -104,6 +133,8 @@ class BinaryExpr : public Expression {
     std::unique_ptr<Expression> left;
     BinaryOp op;
     std::unique_ptr<Expression> right;
+    mutable std::optional<BaseType> operand_type;  //< static type of both operands, if known
+    mutable std::optional<ValueType> folded;  //< value of a constant expression, if folded
 
    public:
     BinaryExpr(const Position pos, std::unique_ptr<Expression> left, BinaryOp op,
@@ -113,6 +144,20 @@ class BinaryExpr : public Expression {
     [[nodiscard]] auto get_left() const -> const Expression *;
     [[nodiscard]] auto get_operator() const -> BinaryOp;
     [[nodiscard]] auto get_right() const -> const Expression *;
+
+    /**
+     * @brief get the type both operands are statically known to have, filled in by the resolver
+     *
+     * Empty if the operands differ in type or either of them is only known at runtime
+     */
+    [[nodiscard]] auto get_operand_type() const -> std::optional<BaseType> { return operand_type; }
+    void set_operand_type(std::optional<BaseType> type) const { operand_type = type; }
+
+    /**
+     * @brief get the precomputed value of the expression, filled in by the constant folder
+     */
+    [[nodiscard]] auto get_folded() const -> const std::optional<ValueType> & { return folded; }
+    void set_folded(std::optional<ValueType> value) const { folded = std::move(value); }
 };
 
 /**
@@ -132,7 +177,7 @@ class CallExpr : public Expression {
     void accept(Visitor &visitor) const override;
 
     [[nodiscard]] auto get_func_name() const -> const Expression *;
-    [[nodiscard]] auto get_args() const -> const std::vector<const Expression *>;
+    [[nodiscard]] auto get_args() const -> NodeView<Expression> { return node_view(args); }
 };
 
 /**
@@ -149,5 +194,5 @@ class BindFrtExpr : public Expression {
     void accept(Visitor &visitor) const override;
 
     [[nodiscard]] auto get_func_name() const -> const Expression *;
-    [[nodiscard]] auto get_args() const -> const std::vector<const Expression *>;
+    [[nodiscard]] auto get_args() const -> NodeView<Expression> { return node_view(args); }
 };
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "block.h"
+#include "node_view.h"
 #include "type.h"
 #include "variable.h"
 
@@ -17,11 +19,11 @@ class Visitor;
 class FuncSignature : public Node {
     std::unique_ptr<Type> ret_type;  //< the return type of the function
     std::vector<std::unique_ptr<VariableSignature>> args;  //< the signature of the function's arguments
-    std::string name;  //< the name of the function
+    Symbol name;  //< the name of the function
 
    public:
     FuncSignature(Position pos, std::unique_ptr<Type> ret,
-                  std::vector<std::unique_ptr<VariableSignature>> args, std::string name);
+                  std::vector<std::unique_ptr<VariableSignature>> args, Symbol name);
 
     void accept(Visitor &visitor) const;
 
@@ -38,33 +40,66 @@ class FuncSignature : public Node {
     /**
      * @brief get the function's parameter
      */
-    [[nodiscard]] auto get_params() const -> const std::vector<const VariableSignature *>;
+    [[nodiscard]] auto get_params() const -> NodeView<VariableSignature> { return node_view(args); }
 
     /**
      * @brief get the function's name
      */
-    [[nodiscard]] auto get_name() const -> std::string;
+    [[nodiscard]] auto get_name() const -> const std::string & { return name.str(); }
+
+    /**
+     * @brief get the function's interned name
+     */
+    [[nodiscard]] auto get_symbol() const -> Symbol { return name; }
 };
 
+class Function;
+
+/**
+ * @brief parses the skipped body of a function and attaches it with `Function::set_body`
+ */
+using BodyLoader = std::function<void(const Function &)>;
+
 /**
  * @brief class representing a parsed function
+ *
+ * The body of a function may be skipped by the parser, in which case it is parsed on the
+ * function's first call, see `parse_body`.
  */
 class Function : public Node {
    private:
     std::unique_ptr<FuncSignature> signature;  //< the signature of the function
-    std::unique_ptr<Block> body;  //< the function's body
+    mutable std::unique_ptr<Block> body;  //< the function's body, nullptr until it is parsed
+    mutable BodyLoader body_loader;  //< parses the skipped body, empty once it is parsed
 
    public:
     Function(std::unique_ptr<FuncSignature> signature, std::unique_ptr<Block> body);
+
+    /**
+     * @brief construct a function whose body was skipped
+     */
+    Function(std::unique_ptr<FuncSignature> signature, BodyLoader body_loader);
     void accept(Visitor &visitor) const;
 
+    /**
+     * @brief parse the body if it was skipped
+     *
+     * @return true if the body was parsed just now
+     */
+    auto parse_body() const -> bool;
+
+    /**
+     * @brief attach the skipped body once it is parsed
+     */
+    void set_body(std::unique_ptr<Block> parsed) const { body = std::move(parsed); }
+
     /**
      * @brief get the function's signature
      */
     [[nodiscard]] auto get_signature() const -> const FuncSignature *;
 
     /**
-     * @brief get the function's body
+     * @brief get the function's body, nullptr if it was skipped and is not parsed yet
      */
     [[nodiscard]] auto get_body() const -> const Block *;
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "local_function.h"
+#include "symbol.h"
+
+class ProgramStream;
+
+/**
+ * @brief table of global functions (user-defined or built-in), indexed by their names
+ *
+ * The table can be fed from a `ProgramStream`, in which case the functions of the program are
+ * only parsed once a lookup misses. Each of them is registered and resolved as it arrives.
+ */
+class FunctionTable {
+   private:
+    std::unordered_map<Symbol, std::shared_ptr<Callable>> functions;  //< functions by name
+    ProgramStream *stream = nullptr;  //< source of the functions not parsed yet, if any
+
+    /**
+     * @brief parse the next function of the stream, register and resolve it
+     *
+     * @return false if there are no more functions
+     */
+    auto load_next() -> bool;
+
+   public:
+    FunctionTable() = default;
+
+    /**
+     * @brief construct with a vector of builtin functions
+     */
+    FunctionTable(const std::vector<std::shared_ptr<Callable>> &builtins);
+
+    /**
+     * @brief add a function to the table
+     *
+     * @return false if a function with the same name is already present
+     */
+    auto add(std::shared_ptr<Callable> func) -> bool;
+
+    /**
+     * @brief find a function by its name, nullptr if there is none
+     */
+    [[nodiscard]] auto find(Symbol name) const -> std::shared_ptr<Callable>;
+
+    /**
+     * @brief find a function by its name, nullptr if there is none
+     */
+    [[nodiscard]] auto find(const std::string &name) const -> std::shared_ptr<Callable>;
+
+    /**
+     * @brief take the program's functions from a stream, parsing them as they are needed
+     */
+    void stream_from(ProgramStream *source);
+
+    /**
+     * @brief find a function by its name, parsing further functions from the stream until it
+     * is found, nullptr if there is none
+     */
+    auto load(Symbol name) -> std::shared_ptr<Callable>;
+
+    /**
+     * @brief parse, register and resolve all the functions remaining in the stream
+     */
+    void load_all();
+};
@@ -1,31 +1,69 @@
 #pragma once
 
+#include <cstdio>
 #include <memory>
 
 #include "position.h"
+#include "source_buffer.h"
 
 /**
  * @brief class representing the input document and tracking the position in it
+ *
+ * The whole document is held in a `SourceBuffer`, characters are read by advancing a cursor over
+ * it.
  */
 class InputManager {
    private:
     std::shared_ptr<Position> position;  //< the current position in the document
-    std::shared_ptr<std::istream> input_stream;  //< the input stream
-    char last_char;  //< the last character received from the input
+    std::shared_ptr<const SourceBuffer> source;  //< the source document
+    const char *cursor;  //< the next character of the document
+    const char *limit;  //< the end of the document
+    char last_char = 0;  //< the last character received from the input
     bool handed_back = false;  //< whether the current character has been returned back
     bool eof = false;  //< whether we have reached the end of the file
 
    public:
+    /**
+     * @brief read the entire stream and walk over its contents
+     */
     InputManager(std::shared_ptr<Position> position, std::shared_ptr<std::istream> input);
-    
+
+    InputManager(std::shared_ptr<Position> position, std::shared_ptr<const SourceBuffer> source);
+
+    /**
+     * @brief walk over the contents of a document from a given offset
+     *
+     * `position` must be the position of the character at the offset
+     */
+    InputManager(std::shared_ptr<Position> position, std::shared_ptr<const SourceBuffer> source,
+                 size_t offset);
+
     /**
      * @brief get the next character from the input and adjust position
+     *
+     * Windows line endings are read as a single '\n', the end of the document as EOF
      */
-    auto get_next_char() -> char;
+    auto get_next_char() -> char {
+        if (handed_back) {
+            handed_back = false;
+            return last_char;
+        }
+
+        if (cursor == limit) {
+            last_char = EOF;
+        } else {
+            last_char = *cursor++;
+            if (last_char == '\r' && cursor != limit && *cursor == '\n') last_char = *cursor++;
+        }
+        if (last_char == EOF) eof = true;
+
+        position->adjust_position(last_char);
+        return last_char;
+    }
 
     /**
      * return a copy of the current position
-     */ 
+     */
     [[nodiscard]] auto save_position() const -> Position;
 
     /**
@@ -42,4 +80,38 @@ class InputManager {
      * @brief returns true if the source document has ended
      */
     [[nodiscard]] auto end() const -> bool;
+
+    /**
+     * @brief get a pointer to the next unread character of the document
+     *
+     * A handed back character is not accounted for, it lies right before the cursor
+     */
+    [[nodiscard]] auto get_cursor() const -> const char * { return cursor; }
+
+    /**
+     * @brief get the source document
+     */
+    [[nodiscard]] auto get_source() const -> const std::shared_ptr<const SourceBuffer> & {
+        return source;
+    }
+
+    /**
+     * @brief get a pointer past the last character of the document
+     */
+    [[nodiscard]] auto get_limit() const -> const char * { return limit; }
+
+    /**
+     * @brief move the cursor over a run of characters the caller has already examined
+     *
+     * The run must directly follow the cursor and must not contain line breaks, nor may a character
+     * be handed back
+     *
+     * @param run_end the first character after the run
+     */
+    void advance_to(const char *run_end) {
+        if (run_end == cursor) return;
+        position->advance_column(static_cast<uint32_t>(run_end - cursor));
+        cursor = run_end;
+        last_char = cursor[-1];
+    }
 };
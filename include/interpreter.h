@@ -1,8 +1,14 @@
 #pragma once
 
+#include <utility>
+
+#include "engine.h"
 #include "exceptions.h"
+#include "function_table.h"
 #include "interpreter_helpers.h"
 #include "local_function.h"
+#include "program_stream.h"
+#include "value_stack.h"
 #include "visitor.h"
 
 /**
@@ -13,18 +19,29 @@
  *      - weak typing - implicit casting
  *      - passing variables as a reference
  */
-class InterpreterVisitor : public Visitor {
+class InterpreterVisitor : public Visitor, public Engine {
    private:
     ValType current_value;        //< value returned by an expression/function/identifier
     TypeType current_type;        //< currently interpreted type
-    std::weak_ptr<Variable> var;  //< variable pointer, received from an identifier
+    Variable *var = nullptr;  //< variable pointer, received from an identifier
+    const Node *node = nullptr;  //< the innermost node being visited, locating errors
 
     ReceivedBy receiver;  //< indicator of where we got current_value from
-    bool returning =
-        false;  //< indicator telling us whether we are currently returning from a function
+    Completion completion = Completion::NORMAL;  //< how the last visited statement completed
+    bool tail_position = false;  //< whether the call being visited is returned right away
+
+    /**
+     * @brief a call returned right away, run in place of the frame that made it
+     */
+    struct TailCall {
+        std::shared_ptr<Callable> callee;  //< the called function, kept alive for the call
+        GlobalFunction *target;  //< the user-defined function the call ends up running
+        ArgVector args;  //< the checked and cast arguments of `target`
+        Position position;  //< the call site
+    };
+    std::optional<TailCall> tail_call;  //< tail call waiting for the current body to return
 
-    std::vector<std::shared_ptr<Callable>>
-        functions;  //< vector of available global functions (either user-defined or built-in)
+    FunctionTable functions;  //< available global functions (either user-defined or built-in)
     auto decorate(ValType decorator, ValType decoratee) -> ValType;
 
     /**
@@ -33,6 +50,23 @@ class InterpreterVisitor : public Visitor {
     void register_function(const Function *func);
 
     std::vector<CallStackFrame> call_stack;  //<  the call stack, growing with each function call
+    size_t max_depth = default_max_depth;    //< maximal number of frames on the call stack
+    std::vector<VarRef> args;                //< arguments of all active frames
+    std::vector<size_t> scopes;  //< block scopes of all active frames, as value stack offsets
+    ValueStack values;           //< variables of all active frames
+
+    /**
+     * @brief schedule a tail call, if it can run in place of the current frame
+     *
+     * @return false if the callee has to be called as usual
+     */
+    auto defer_tail_call(const std::shared_ptr<Callable> &callee, ArgVector &call_args,
+                         Position position) -> bool;
+
+    /**
+     * @brief bind the arguments to the parameters of the function running in the current frame
+     */
+    void bind_args(const Function &func, ArgVector &func_args);
 
     /**
      * @brief register a new variable with a given signature
@@ -41,29 +75,94 @@ class InterpreterVisitor : public Visitor {
 
     /**
      * @brief assign the current value to a variable with the given identifier
+     *
+     * The variable is looked up by name unless the resolver assigned it a slot
+     */
+    void modify_var(Symbol identifier, std::optional<VarSlot> slot);
+
+    /**
+     * @brief get a variable of the current frame by its resolved slot
      */
-    void modify_var(const std::string &identifier);
+    auto get_var(VarSlot slot) -> Variable *;
 
     /**
      * @brief prepare a for loop iterator
      */
-    auto get_for_iterator(const ForLoopArgs &args) -> std::weak_ptr<Variable>;
+    auto get_for_iterator(const ForLoopArgs &args) -> Variable *;
 
     /**
      * @brief evaluate a condition
      */
     auto eval_condition(const Expression &expr) -> bool;
 
+    /**
+     * @brief run the statements of a block in the current scope, until one of them returns
+     */
+    void run_statements(const Block &block);
+
+    /**
+     * @brief run the body of a loop while the condition holds, calling `next` after each iteration
+     *
+     * The body's scope is opened once for the whole loop and emptied after each iteration, rather
+     * than opened and closed again by every iteration.
+     */
+    template <typename Next>
+    void run_loop(const Expression &condition, const Block &body, Next &&next) {
+        push_scope();
+        while (eval_condition(condition)) {
+            run_statements(body);
+            if (completion != Completion::NORMAL) break;
+            values.truncate(scopes.back());
+            next();
+        }
+        pop_scope();
+    }
+
+    /**
+     * @brief visit a node, locating the errors raised while visiting it at the node
+     *
+     * Errors are not caught at each node: the innermost node being visited is tracked instead,
+     * and `locate_errors` attaches its position to an error once, where it leaves the program.
+     */
     template <typename T>
     void try_visit(T obj) {
+        const Node *outer = std::exchange(node, obj);
+        obj->accept(*this);
+        node = outer;
+    }
+
+    /**
+     * @brief run a part of the program, locating its errors at the innermost visited node
+     *
+     * Errors raised outside of any node are passed on as they are.
+     */
+    template <typename F>
+    void locate_errors(F &&run) {
+        node = nullptr;
         try {
-            obj->accept(*this);
+            run();
         } catch (InterpreterError &e) {
-            throw GeneralError(obj->get_position(), e.what());
+            if (!node) throw;
+            throw GeneralError(node->get_position(), e.what());
         }
     }
 
    public:
+    /**
+     * @brief default maximal depth of nested calls
+     *
+     * Walking the syntax tree recurses on the native stack, the default leaves room for the calls
+     * of moderately complex functions within a typical 8 MiB stack.
+     */
+    static constexpr size_t default_max_depth = 6000;
+
+    /**
+     * @brief largest depth of nested calls that may be requested
+     *
+     * The default is already close to what an 8 MiB native stack takes, so it may only be lowered.
+     */
+    static constexpr size_t max_depth_limit = default_max_depth;
+
     InterpreterVisitor() = default;
 
     /**
@@ -72,6 +171,14 @@ class InterpreterVisitor : public Visitor {
     InterpreterVisitor(std::vector<std::shared_ptr<Callable>> builtins);
     void visit(const Program &program) override;
 
+    /**
+     * @brief call `main` as soon as it is parsed, parsing the other functions as they are needed
+     *
+     * The rest of the program is parsed after `main` returns, so that its errors are still
+     * reported.
+     */
+    void run(ProgramStream &stream);
+
     void visit(const LiteralExpr &expr) override;
     void visit(const IdentifierExpr &expr) override;
     void visit(const UnaryExpr &expr) override;
@@ -104,35 +211,64 @@ class InterpreterVisitor : public Visitor {
     /**
      * @brief return the current value
      */
-    [[nodiscard]] auto get_value() const -> ValType;
+    [[nodiscard]] auto get_value() const -> ValType override;
 
     /**
      * @brief override the current value
      */
-    void override_value(ValType val);
+    void override_value(ValType val) override;
+
+    /**
+     * @brief push a call stack frame for the function's arguments and walk its body
+     */
+    void run_function(const Function &func, ArgVector &args) override;
 
     /**
-     * @brief push a new call stack frame into the stack
+     * @brief resolve a function against the global functions
      */
-    void push_call_stack(CallStackFrame frame);
+    void resolve(const Function &func) override;
 
     /**
-     * @brief pop the call stack
+     * @brief limit the depth of nested calls, before running a program
+     *
+     * Calls nested any deeper raise an error at the call site.
+     */
+    void set_max_depth(size_t depth);
+
+    /**
+     * @brief push a new, empty call stack frame into the stack
+     */
+    void push_call_stack();
+
+    /**
+     * @brief pop the call stack, releasing the frame's variables
      */
     void pop_call_stack();
 
     /**
-     * @brief get a variable reference in the current frame by identifier
+     * @brief open a block scope in the current frame
+     */
+    void push_scope();
+
+    /**
+     * @brief close the innermost block scope, releasing its variables
+     */
+    void pop_scope();
+
+    /**
+     * @brief get a variable in the current frame by identifier, nullptr if there is none
      */
-    auto find_var_in_frame(const std::string &name) -> std::weak_ptr<Variable>;
+    auto find_var_in_frame(const std::string &name) -> Variable *;
+    auto find_var_in_frame(Symbol name) -> Variable *;
 
     /**
-     * @brief find a global function with a given name
+     * @brief find a global function with a given name, parsing it first when streaming
      */
     auto find_func(const std::string &name) -> std::shared_ptr<Callable>;
+    auto find_func(Symbol name) -> std::shared_ptr<Callable>;
 
     /**
      * initialize a variable with a given type
      */
-    auto init_var(const Type &type) -> ValType;
+    auto init_var(const Type &type) -> ValType override;
 };
@@ -5,7 +5,9 @@
  * Header containing definitions of interpreter helper structures and enums
  */
 
+#include "exceptions.h"
 #include "local_function.h"
+#include "symbol.h"
 
 /**
  * @brief value returned by functions/expressions/variables
@@ -18,45 +20,41 @@ using ValType =
  */
 using TypeType = std::variant<const Type*, BaseType>;
 
-/**
- * @brief variable reference
- *
- * The struct holds a pointer to the original variable and a new name under which it appears
- */
-struct VarRef {
-    std::shared_ptr<Variable> ref;  //< variable reference
-    std::string curr_name;          //< name in current scope
-};
-
-
 /**
  * @brief the variable definition
  *
- * A variable contains its own signature and value
+ * A variable contains its own signature and value. Variables live inline in an engine's
+ * `ValueStack`, everything else refers to them through plain pointers.
  */
 struct Variable {
-    const VariableSignature& signature;  //< variable type and name as parsed by the parser
+    const VariableSignature* signature = nullptr;  //< variable type and name as parsed by the parser
     ValType value;
-    auto get_type() -> const Type* { return signature.get_type(); }
+    auto get_type() -> const Type* { return signature->get_type(); }
 };
 
 /**
- * @brief The current scope defined by blocks of code
+ * @brief variable reference
+ *
+ * The struct holds a pointer to the original variable and a new name under which it appears
  */
-struct BlockScope {
-    std::vector<std::shared_ptr<Variable>> vars;  //< variables in current scope (block)
+struct VarRef {
+    Variable* ref;     //< variable reference
+    Symbol curr_name;  //< name in current scope
 };
 
 /**
  * @brief a single frame of the call stack
  *
- * Call stack frames get pushed during a function call and popped right after it.
- * They hold a vector of function arguments as references to variables (temporary or other).
- * Block scopes are held here as well.
+ * Call stack frames get pushed during a function call and popped right after it. A frame only
+ * records where its part of the interpreter's stacks begins: its arguments (references to
+ * variables, temporary or other) and its block scopes, each block scope being the start of its
+ * variables on the value stack.
  */
 struct CallStackFrame {
-    std::vector<std::shared_ptr<VarRef>> args;  //< variables passed by reference
-    std::vector<BlockScope> var_scope;          //< variables originating inside the function
+    size_t args = 0;    //< index of the frame's first argument
+    size_t scopes = 0;  //< index of the frame's first block scope
+    size_t values = 0;  //< size of the value stack when the frame was pushed
+    const Function *function = nullptr;  //< the function running in the frame
 };
 
 /**
@@ -67,12 +65,50 @@ enum class ReceivedBy {
     VAR,
 };
 
+/**
+ * @brief small enum representing how the last visited statement completed
+ *
+ * Blocks and loops stop at the first statement that does not complete normally, so a `ret` leaves
+ * any number of them with one check each.
+ */
+enum class Completion {
+    NORMAL,  //< the next statement runs
+    RETURN,  //< the function returns, with its value in the current value
+};
+
 /**
  * @brief a function argument, either a value or reference, depending on user input
+ *
+ * References point into the caller's frame and are only valid for the duration of the call
  */
-using Arg = std::variant<std::shared_ptr<Variable>, ValType>;
+using Arg = std::variant<Variable*, ValType>;
 
 /**
  * @brief a vector of function arguments
  */
 using ArgVector = std::vector<Arg>;
+
+/**
+ * @brief the value a freshly declared variable of the given type starts with
+ *
+ * Function types produce an empty `LocalFunction` carrying the type, so that it can be used as
+ * the target of a type cast.
+ */
+auto default_value(const Type& type) -> ValType;
+
+/**
+ * @brief cast a value to the given type, the way assigning it to a variable of that type does
+ *
+ * Function values are only checked against the type, without creating its default value.
+ */
+auto cast_value(const ValType& value, const Type& type) -> ValType;
+
+/**
+ * @brief the runtime value of a literal parsed from the source
+ */
+auto literal_value(const ValueType& value) -> ValType;
+
+/**
+ * @brief the error raised by a call nested deeper than an engine allows
+ */
+auto call_depth_error(size_t max_depth) -> InterpreterError;
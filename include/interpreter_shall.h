@@ -1,8 +1,24 @@
 #pragma once
+#include <string>
+#include <type_traits>
+#include <utility>
+
 #include "exceptions.h"
 
-template <typename T>
-auto shall(T arg, std::string error) -> T {
-    if (!arg) throw InterpreterError(error);
-    return std::move(arg);
+/**
+ * @brief throw an `InterpreterError` unless the argument holds, return the argument otherwise
+ *
+ * The message is only built when the check fails: it is either a string, preferably a literal, or
+ * a function returning the message, for messages composed at runtime.
+ */
+template <typename T, typename Message>
+auto shall(T arg, Message &&error) -> T {
+    if (!arg) [[unlikely]] {
+        if constexpr (std::is_invocable_v<Message>) {
+            throw InterpreterError(std::forward<Message>(error)());
+        } else {
+            throw InterpreterError(std::forward<Message>(error));
+        }
+    }
+    return arg;
 }
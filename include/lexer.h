@@ -28,11 +28,35 @@ class Lexer {
      */
     Lexer(std::shared_ptr<std::istream> input_stream, bool verbose);
 
+    /**
+     * @brief Lexer's constructor, reading an already loaded source document
+     * @param verbose Whether we want verbose logging
+     */
+    Lexer(std::shared_ptr<const SourceBuffer> source, bool verbose = false);
+
+    /**
+     * @brief Lexer's constructor, reading an already loaded source document from a given offset
+     * @param position the position of the character at the offset
+     */
+    Lexer(std::shared_ptr<const SourceBuffer> source, size_t offset, Position position,
+          bool verbose = false);
+
     /**
      * @brief get the next token from the tokenizer
      */
     auto get_token() -> Token;
 
+    /**
+     * @brief get the offset of the last token's first character in the source document
+     */
+    [[nodiscard]] auto get_token_offset() const -> size_t;
+
+    /**
+     * @brief create a lexer reading the same source document from a given offset
+     * @param position the position of the character at the offset
+     */
+    [[nodiscard]] auto resume_at(size_t offset, Position position) const -> std::shared_ptr<Lexer>;
+
     /**
      * @brief function returning true if the entire file is read
      */
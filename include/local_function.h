@@ -1,18 +1,21 @@
 #pragma once
 
+#include <memory>
 #include <variant>
+#include <vector>
 
 #include "function.h"
 
 struct Variable;
 struct VarRef;
 class Callable;
-class InterpreterVisitor;
+class Engine;
+class GlobalFunction;
 
 using ValType =
     std::variant<std::monostate, std::string, int, double, bool, std::shared_ptr<Callable>>;
 
-using Arg = std::variant<std::shared_ptr<Variable>, ValType>;
+using Arg = std::variant<Variable*, ValType>;
 using ArgVector = std::vector<Arg>;
 
 /**
@@ -21,10 +24,45 @@ using ArgVector = std::vector<Arg>;
 class Callable {
    public:
     virtual ~Callable() = default;
-    virtual void call(InterpreterVisitor& interpreter, ArgVector params) = 0;
+
+    /**
+     * @brief call the function with the arguments of the call site
+     *
+     * The arguments belong to the caller and are used in place: they are cast to the parameter
+     * types and bound arguments are inserted in front of them, so that no layer copies them.
+     * Reserving room for `bound_count()` more arguments spares the inserts any reallocation.
+     */
+    virtual void call(Engine& engine, ArgVector& args) = 0;
     [[nodiscard]] virtual auto get_func() const -> const Function* = 0;
     [[nodiscard]] virtual auto get_type() const -> const Type* = 0;
     [[nodiscard]] virtual auto get_name() const -> const std::string = 0;
+
+    /**
+     * @brief find the user-defined function a call ends up running, so the engine can run it
+     *
+     * Bound and decorated functions resolve to the function they wrap, prepending their bound
+     * arguments to `args`. Builtins are not run by the engine, they return nullptr and leave
+     * `args` untouched, as does a function that ends up calling one.
+     */
+    virtual auto get_target(ArgVector& args) -> GlobalFunction* {
+        (void)args;
+        return nullptr;
+    }
+
+    /**
+     * @brief number of arguments the function binds in front of the ones it is called with
+     */
+    [[nodiscard]] virtual auto bound_count() const -> size_t { return 0; }
+
+    /**
+     * @brief the function's type with its first `skip` parameters bound
+     *
+     * Cloned once for each number of bound parameters, then shared by all functions binding them.
+     */
+    auto bound_type(size_t skip) -> std::shared_ptr<const Type>;
+
+   private:
+    std::vector<std::shared_ptr<const Type>> bound_types;  //< types by number of bound parameters
 };
 
 /**
@@ -37,10 +75,34 @@ class GlobalFunction : public Callable {
 
    public:
     GlobalFunction(const Function* func);
-    void call(InterpreterVisitor& interpreter, ArgVector params) override;
+    void call(Engine& engine, ArgVector& args) override;
     [[nodiscard]] auto get_func() const -> const Function* override;
-    auto prepare_func_args(InterpreterVisitor& interpreter, ArgVector& args) const
-        -> std::vector<std::shared_ptr<VarRef>>;
+    void prepare_func_args(ArgVector& args) const;
+
+    /**
+     * @brief parse the body if it was skipped, then check and cast the arguments of a call
+     */
+    void prepare_call(Engine& engine, ArgVector& args) const;
+
+    /**
+     * @brief cast the value the function returned to its return type
+     */
+    void finish_call(Engine& engine) const;
+
+    /**
+     * @brief check whether a tail call can run the function in place of one returning `ret_type`
+     *
+     * Both have to return the same type, so that the caller's cast of the returned value has no
+     * effect and can be skipped.
+     */
+    [[nodiscard]] auto can_replace(const Type* ret_type) const -> bool {
+        return type->get_ret_type()->is_equal_to(ret_type);
+    }
+
+    auto get_target(ArgVector& args) -> GlobalFunction* override {
+        (void)args;
+        return this;
+    }
     [[nodiscard]] auto get_type() const -> const Type* override { return type.get(); }
     [[nodiscard]] auto get_name() const -> const std::string override {
         return func->get_signature()->get_name();
@@ -50,19 +112,24 @@ class GlobalFunction : public Callable {
 /**
  * @brief class for holding decorated/bind fronted functions as variables
  *
- * Local functions differ from global functions only with their signature.
+ * Local functions differ from global functions only with their signature. Binding arguments to a
+ * function that already binds some yields one function binding both lists, so that a call goes
+ * through a single layer however many times the function was bound.
  */
 class LocalFunction : public Callable {
    private:
     std::shared_ptr<Callable> callee;
-    std::unique_ptr<Type> type;
+    std::shared_ptr<const Type> type;
     std::string name;
     ArgVector bound_args;
+    size_t bound = 0;  //< arguments bound by this function and the functions it calls
 
    public:
     LocalFunction(std::shared_ptr<Callable> callee_func, ArgVector bound_args);
     LocalFunction(std::unique_ptr<Type> type);
-    void call(InterpreterVisitor& interpreter, ArgVector params) override;
+    void call(Engine& engine, ArgVector& args) override;
+    auto get_target(ArgVector& args) -> GlobalFunction* override;
+    [[nodiscard]] auto bound_count() const -> size_t override { return bound; }
     [[nodiscard]] auto get_func() const -> const Function* override;
     [[nodiscard]] auto get_type() const -> const Type* override { return type.get(); }
     [[nodiscard]] auto get_name() const -> const std::string override { return name; }
@@ -1,13 +1,15 @@
 #pragma once
 
+#include "arena.h"
 #include "position.h"
 
 /**
  * @brief Class representing a single node in the AST
  * The class stores data on a block's position after being parsed
- * This is the class from which all AST elements derive
+ * This is the class from which all AST elements derive, nodes created while parsing are placed in
+ * the program's arena
  */
-class Node {
+class Node : public ArenaAllocated {
    private:
     const Position pos;  //< block's position
 
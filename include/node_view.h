@@ -0,0 +1,39 @@
+#pragma once
+/**
+ * @file node_view.h
+ *
+ * Non-owning views over the children of syntax tree nodes
+ */
+
+#include <memory>
+#include <ranges>
+#include <vector>
+
+/**
+ * @brief projection of an owning node pointer onto a const raw pointer
+ */
+struct NodeGet {
+    template <typename T>
+    auto operator()(const std::unique_ptr<T> &node) const noexcept -> const T * {
+        return node.get();
+    }
+};
+
+/**
+ * @brief random access view over the children of a node, yielding `const T *`
+ *
+ * The view borrows the node's own storage, so traversing or indexing it never allocates. It is
+ * valid as long as the node it was taken from.
+ */
+template <typename T>
+using NodeView =
+    std::ranges::transform_view<std::ranges::ref_view<const std::vector<std::unique_ptr<T>>>,
+                                NodeGet>;
+
+/**
+ * @brief view a vector of owned nodes
+ */
+template <typename T>
+auto node_view(const std::vector<std::unique_ptr<T>> &nodes) -> NodeView<T> {
+    return NodeView<T>(std::ranges::ref_view(nodes), NodeGet{});
+}
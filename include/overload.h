@@ -0,0 +1,13 @@
+#pragma once
+
+/**
+ * @brief overload template for visiting variants with a set of lambdas
+ *
+ * Inspired by: https://www.modernescpp.com/index.php/smart-tricks-with-fold-expressions/
+ */
+template <typename... Ts>
+struct Overload : Ts... {
+    using Ts::operator()...;
+};
+template <class... Ts>
+Overload(Ts...) -> Overload<Ts...>;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <optional>
 
 #include "block.h"
@@ -32,6 +33,9 @@ class Parser {
    private:
     std::shared_ptr<Lexer> lexer;  ///< Source lexer for tokens.
     Token current_token;           ///< Current token being processed.
+    bool started = false;          ///< Whether the first token of the program was read.
+    bool defer = false;            ///< Whether function bodies are skipped until their first call.
+    std::function<void(const Function&)> on_body;  ///< Pass applied to each skipped body once parsed.
 
     /**
      * @brief Parses a binary expression using given condition and next-step logic.
@@ -54,6 +58,13 @@ class Parser {
      */
     auto parse_func_def() -> FuncPtr;
 
+    /**
+     * @brief Skips a block by matching its braces.
+     *
+     * @return A loader parsing the skipped block into a function's body.
+     */
+    auto skip_block() -> BodyLoader;
+
     /**
      * @brief Parses a function signature.
      * `func_signature  = type, identifier, [function_sign_op, function_def_params]`
@@ -359,9 +370,12 @@ class Parser {
         return current_token.get_position();
     };
 
+    /**
+     * @brief throw a `ParserError` at the current token unless the argument holds
+     */
     template <typename T>
-    auto shall(T arg, std::string error) -> T {
-        if (!arg) throw ParserError(get_position(), error);
+    auto shall(T arg, const char *error) -> T {
+        if (!arg) [[unlikely]] throw ParserError(get_position(), error);
         return std::move(arg);
     }
 
@@ -380,6 +394,25 @@ class Parser {
      */
     auto parse() -> ProgramPtr;
 
+    /**
+     * @brief Parses the next function definition and appends it to the program.
+     *
+     * Allows consuming the source one function at a time, the nodes are placed in the
+     * program's arena.
+     * @return Pointer to the parsed function, nullptr once the whole source was parsed.
+     */
+    auto parse_function(Program& program) -> const Function*;
+
+    /**
+     * @brief Skips the bodies of functions, parsing each one on the function's first call.
+     *
+     * Only the braces of a skipped body are checked, syntax errors within it are reported once
+     * it is parsed.
+     *
+     * @param on_body Optional pass applied to each body once it is parsed.
+     */
+    void defer_bodies(std::function<void(const Function&)> on_body = nullptr);
+
     /**
      * @brief Parses a single statement.
      * @return Smart pointer to parsed statement.
@@ -23,7 +23,10 @@ class Position {
     /**
      * @brief increment the current line, resetting the column
      */
-    auto increment_line() -> uint32_t;
+    auto increment_line() -> uint32_t {
+        column = 1;
+        return line++;
+    }
 
     /**
      * @brief get the current column
@@ -33,7 +36,12 @@ class Position {
     /**
      * @brief increment the current column
      */
-    auto increment_column() -> uint32_t;
+    auto increment_column() -> uint32_t { return column++; }
+
+    /**
+     * @brief move the current column by a number of characters
+     */
+    void advance_column(uint32_t count) { column += count; }
 
     /**
      * @brief adjust the position for a given character
@@ -42,6 +50,12 @@ class Position {
      *
      * @param ch the character to be checked
      */
-    void adjust_position(char ch);
+    void adjust_position(char ch) {
+        if (ch == '\n') {
+            increment_line();
+        } else {
+            increment_column();
+        }
+    }
     friend auto operator<<(std::ostream &os, Position pos) -> std::ostream &;
 };
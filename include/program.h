@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "function.h"
+#include "node_view.h"
 
 class Visitor;
 
@@ -14,15 +15,31 @@ class Visitor;
  */
 class Program {
    private:
+    std::unique_ptr<Arena> arena;  //< memory of the syntax tree, released after all its nodes
     std::vector<std::unique_ptr<Function>> functions;  //< user-defined functions
 
    public:
-    Program(std::vector<std::unique_ptr<Function>> functions) : functions(std::move(functions)) {}
+    Program(std::vector<std::unique_ptr<Function>> functions,
+            std::unique_ptr<Arena> arena = nullptr)
+        : arena(std::move(arena)), functions(std::move(functions)) {}
 
     void accept(Visitor &visitor) const;
 
     /**
-     * @brief get the functions vector as a vector of const pointers to Function
+     * @brief append a function parsed after the program was created
      */
-    [[nodiscard]] auto get_functions() const -> const std::vector<const Function *>;
+    void add_function(std::unique_ptr<Function> function) {
+        functions.push_back(std::move(function));
+    }
+
+    /**
+     * @brief get the arena holding the syntax tree, nullptr if it was built on the heap
+     */
+    [[nodiscard]] auto get_arena() const -> const Arena * { return arena.get(); }
+    [[nodiscard]] auto get_arena() -> Arena * { return arena.get(); }
+
+    /**
+     * @brief get the functions as a view of const pointers to Function
+     */
+    [[nodiscard]] auto get_functions() const -> NodeView<Function> { return node_view(functions); }
 };
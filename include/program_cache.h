@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * @file program_cache.h
+ *
+ * Precompiled programs, stored between runs
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "program.h"
+#include "source_buffer.h"
+
+/**
+ * @brief a binary image of a parsed program, reused by later runs over the same source
+ *
+ * The image holds the syntax tree along with the values of folded constant expressions, and is
+ * keyed by the size and hash of the source document, the version of the interpreter and of the
+ * image format, and whether the program was folded. An image not matching all of them is a miss,
+ * so a stale cache is never run - the program is parsed again and the image replaced.
+ *
+ * Images are memory-mapped when loaded. Resolver annotations are not stored, they are cheap to
+ * recompute and refer to the function table of the running engine.
+ */
+class ProgramCache {
+   private:
+    std::string path;  //< the cache file
+    bool folded;  //< whether the cached program has its constant expressions folded
+
+   public:
+    static constexpr uint32_t format_version = 1;  //< bumped whenever the image layout changes
+
+    /**
+     * @brief construct a cache stored in a given file
+     *
+     * @param folded whether the program is constant folded before it is stored
+     */
+    ProgramCache(std::string path, bool folded) : path(std::move(path)), folded(folded) {}
+
+    /**
+     * @brief get the cache file of a source file
+     *
+     * The cache is stored next to the source (`file.tkom` in `file.tkomc`), unless a cache
+     * directory is given. Files in a cache directory are named after the absolute path of the
+     * source, so sources with the same name do not share a cache.
+     */
+    static auto path_for(const std::string &source_file, const std::string &cache_dir = "")
+        -> std::string;
+
+    /**
+     * @brief load the program cached for a source document
+     *
+     * @return the program, or nullptr if there is no valid image for the source
+     */
+    [[nodiscard]] auto load(const SourceBuffer &source) const -> std::unique_ptr<Program>;
+
+    /**
+     * @brief store the program parsed from a source document, replacing the previous image
+     *
+     * Programs with skipped function bodies cannot be stored. The image is written to a temporary
+     * file first, so concurrent runs never see a partially written one.
+     *
+     * @return true if the image was written
+     */
+    auto store(const Program &program, const SourceBuffer &source) const -> bool;
+
+    [[nodiscard]] auto get_path() const -> const std::string & { return path; }
+};
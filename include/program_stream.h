@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "parser.h"
+#include "program.h"
+
+/**
+ * @brief a program parsed one function at a time, as its functions are needed
+ *
+ * Engines pull functions from the stream while the program is already running, so execution
+ * can start long before a large source document is parsed in full. The functions parsed so far
+ * are owned by the stream's program.
+ */
+class ProgramStream {
+   private:
+    std::shared_ptr<Parser> parser;  //< the parser producing the functions
+    std::unique_ptr<Program> program;  //< the functions parsed so far
+    std::function<void(const Function &)> on_parsed;  //< called for each freshly parsed function
+    bool finished = false;  //< whether the whole source was parsed
+
+   public:
+    /**
+     * @brief construct a stream over the parser's source
+     *
+     * @param on_parsed optional pass applied to each function before it is handed out
+     */
+    ProgramStream(std::shared_ptr<Parser> parser,
+                  std::function<void(const Function &)> on_parsed = nullptr);
+
+    /**
+     * @brief parse the next function, nullptr once the whole source was parsed
+     */
+    auto next() -> const Function *;
+
+    /**
+     * @brief check whether the whole source was parsed
+     */
+    [[nodiscard]] auto is_finished() const -> bool { return finished; }
+
+    /**
+     * @brief get the functions parsed so far
+     */
+    [[nodiscard]] auto get_program() const -> const Program & { return *program; }
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "function_table.h"
+#include "symbol.h"
+#include "type.h"
+#include "var_slot.h"
+#include "visitor.h"
+
+/**
+ * @brief Resolver pass binding local variable accesses to frame slots
+ *
+ * The resolver walks every function once before it is executed, mirroring the scoping rules of
+ * the interpreter, and annotates:
+ *      - each `IdentifierExpr` referring to a local variable or parameter
+ *      - each `AssignStatement` with the slot it reassigns or declares
+ *      - each `IdentifierExpr` referring to a global function with the function itself, so that
+ *        call sites do not look it up again
+ *      - each `BinaryExpr` whose operands have the same statically known type, so that engines can
+ *        pick a monomorphic kernel instead of dispatching on both operands at runtime
+ *
+ * Static types follow from variable declarations, literals, operators and the return types of
+ * user-defined functions. Variables always hold their declared type, as every assignment casts
+ * into it. Anything else (function values, builtins, mixed operands) stays unknown.
+ *
+ * Nodes left unresolved (global functions, unknown identifiers, re-definitions) are handled
+ * by the interpreter's name lookup, which reports the appropriate error.
+ */
+class Resolver : public Visitor {
+   private:
+    /**
+     * @brief a variable visible in the current function
+     */
+    struct Local {
+        Symbol name;
+        std::optional<BaseType> type;  //< declared type, empty for function types
+    };
+
+    std::vector<std::vector<Local>>
+        scopes;  //< variables visible in the current function, the first scope holds parameters
+    const FunctionTable *globals = nullptr;  //< global functions to bind, if any
+    std::optional<BaseType> current_type;    //< static type of the last visited expression
+
+    /**
+     * @brief find the slot of a visible variable
+     */
+    [[nodiscard]] auto find(Symbol name) const -> std::optional<VarSlot>;
+
+    /**
+     * @brief visit an expression and return its static type
+     */
+    auto infer(const Expression *expr) -> std::optional<BaseType>;
+
+   public:
+    Resolver() = default;
+
+    /**
+     * @brief construct a resolver binding identifiers to the given global functions
+     */
+    Resolver(const FunctionTable *globals);
+
+    void visit(const Program &program) override;
+
+    void visit(const LiteralExpr &expr) override;
+    void visit(const IdentifierExpr &expr) override;
+    void visit(const UnaryExpr &expr) override;
+    void visit(const BinaryExpr &expr) override;
+    void visit(const CallExpr &expr) override;
+    void visit(const BindFrtExpr &expr) override;
+
+    void visit(const ForLoopStatement &stmt) override;
+    void visit(const WhileLoopStatement &stmt) override;
+    void visit(const ConditionalStatement &stmt) override;
+    void visit(const ElseStatement &stmt) override;
+    void visit(const RetStatement &stmt) override;
+    void visit(const CallStatement &stmt) override;
+    void visit(const AssignStatement &stmt) override;
+
+    void visit(const Block &block) override;
+    void visit(const VarType &type) override {
+        (void)type;
+        return;
+    }
+    void visit(const FuncType &type) override {
+        (void)type;
+        return;
+    }
+
+    void visit(const VariableSignature &var) override {
+        (void)var;
+        return;
+    }
+    void visit(const FuncSignature &sign) override {
+        (void)sign;
+        return;
+    }
+    void visit(const Function &func) override;
+};
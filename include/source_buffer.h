@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+/**
+ * @brief the entire source document, held in a single contiguous block of memory
+ *
+ * Regular files are memory-mapped, everything else (pipes, string streams) is read into an owned
+ * buffer in large chunks. Either way the document can be walked with a plain pointer, instead of
+ * going through the stream for every character.
+ */
+class SourceBuffer {
+   private:
+    const char *begin = nullptr;  //< first character of the document
+    size_t length = 0;            //< size of the document in bytes
+    void *mapping = nullptr;      //< the mapped file, if the document was mapped
+    std::string storage;          //< the document, if it was read into memory
+
+    SourceBuffer() = default;
+
+   public:
+    SourceBuffer(const SourceBuffer &) = delete;
+    auto operator=(const SourceBuffer &) -> SourceBuffer & = delete;
+    ~SourceBuffer();
+
+    /**
+     * @brief map a file into memory, reading it if it cannot be mapped
+     *
+     * A file that cannot be opened results in an empty document, like an unreadable stream would
+     */
+    static auto from_file(const std::string &filename) -> std::shared_ptr<const SourceBuffer>;
+
+    /**
+     * @brief read a stream until its end
+     */
+    static auto from_stream(std::istream &input) -> std::shared_ptr<const SourceBuffer>;
+
+    [[nodiscard]] auto data() const -> const char * { return begin; }
+    [[nodiscard]] auto size() const -> size_t { return length; }
+};
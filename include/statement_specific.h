@@ -23,8 +23,8 @@ enum class TokenType;
  * @brief Represents arguments passed to a `for` loop, such as initializer, condition, and iterator
  * expression.
  */
-struct ForLoopArgs {
-    std::variant<std::unique_ptr<Statement>, std::string>
+struct ForLoopArgs : ArenaAllocated {
+    std::variant<std::unique_ptr<Statement>, Symbol>
         iterator;  // identifier or Assign
     std::unique_ptr<Expression> condition;
     friend auto operator<<(std::ostream &os, ForLoopArgs args) -> std::ostream &;
@@ -144,6 +144,7 @@ class AssignStatement : public Statement {
    private:
     std::unique_ptr<Expression> value;
     std::unique_ptr<VariableSignature> var_sign;
+    mutable std::optional<VarSlot> slot;  //< target variable slot, filled in by the resolver
 
    public:
     AssignStatement(Position pos, std::unique_ptr<Expression> value, std::unique_ptr<VariableSignature> sign);
@@ -152,6 +153,15 @@ class AssignStatement : public Statement {
 
     [[nodiscard]] auto get_value() const -> const Expression *;
     [[nodiscard]] auto get_type() const -> const Type *;
-    [[nodiscard]] auto get_identifier() const -> const std::string;
+    [[nodiscard]] auto get_identifier() const -> const std::string &;
+    [[nodiscard]] auto get_symbol() const -> Symbol;
     [[nodiscard]] auto get_signature() const -> const VariableSignature *;
+
+    /**
+     * @brief get the resolved slot of the assigned (or declared) variable
+     *
+     * Empty if the statement was not resolved, or it is invalid in its scope
+     */
+    [[nodiscard]] auto get_slot() const -> std::optional<VarSlot> { return slot; }
+    void set_slot(std::optional<VarSlot> resolved) const { slot = resolved; }
 };
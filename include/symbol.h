@@ -0,0 +1,68 @@
+#pragma once
+/**
+ * @file symbol.h
+ *
+ * Interned identifiers
+ */
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief an interned identifier
+ *
+ * All symbols with the same name share a single string owned by a process-wide table, so
+ * symbols are compared and hashed by pointer, and copying one never allocates.
+ */
+class Symbol {
+   private:
+    const std::string *name;  //< the interned name
+
+    explicit Symbol(const std::string *name) : name(name) {}
+
+   public:
+    /**
+     * @brief construct the symbol of an empty name
+     */
+    Symbol();
+
+    /**
+     * @brief intern a name
+     */
+    explicit Symbol(std::string_view name);
+
+    /**
+     * @brief find the symbol of an already interned name without interning it
+     *
+     * No identifier can refer to a name that was never interned, which lets lookups by name bail
+     * out early.
+     */
+    static auto find(std::string_view name) -> std::optional<Symbol>;
+
+    /**
+     * @brief get the symbol's name
+     */
+    [[nodiscard]] auto str() const -> const std::string & { return *name; }
+
+    /**
+     * @brief get the symbol's unique id
+     */
+    [[nodiscard]] auto id() const -> std::uintptr_t {
+        return reinterpret_cast<std::uintptr_t>(name);
+    }
+
+    auto operator==(const Symbol &other) const -> bool = default;
+
+    friend auto operator<<(std::ostream &os, const Symbol &symbol) -> std::ostream &;
+};
+
+template <>
+struct std::hash<Symbol> {
+    auto operator()(const Symbol &symbol) const noexcept -> size_t {
+        return std::hash<std::uintptr_t>{}(symbol.id());
+    }
+};
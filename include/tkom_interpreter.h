@@ -1,8 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include "interpreter.h"
 #include "parser.h"
+#include "program_cache.h"
+#include "program_stream.h"
+#include "vm.h"
 
 /**
  * @brief small enum representing the input stream
@@ -12,6 +16,38 @@ enum class From {
     FILE
 };
 
+/**
+ * @brief small enum representing the engine executing the parsed program
+ */
+enum class EngineKind {
+    TREE = 0,  //< the tree-walking reference interpreter
+    VM         //< the bytecode virtual machine
+};
+
+/**
+ * @brief small enum representing the optimizations applied to the parsed program
+ */
+enum class OptLevel {
+    O0 = 0,  //< run the program exactly as parsed
+    O1       //< fold constant expressions
+};
+
+/**
+ * @brief small enum representing how the program is parsed before it runs
+ */
+enum class ParseMode {
+    WHOLE = 0,  //< parse the whole program, then run it
+    STREAM      //< run `main` as soon as it is parsed, parsing other functions when needed
+};
+
+/**
+ * @brief small enum representing when the bodies of functions are parsed
+ */
+enum class BodyParsing {
+    EAGER = 0,  //< parse every body along with its signature
+    LAZY        //< skip the bodies, parsing each one on the function's first call
+};
+
 /**
  * @brief the vector of builtin functions
  */
@@ -24,25 +60,59 @@ class TKOMInterpreter {
     private:
         const std::string filename;  //< filename of the source document
         const From from;  //< input source type
+        std::shared_ptr<const SourceBuffer> source;  //< the source document
         std::unique_ptr<Program> program;  //< the parsed program
+        std::unique_ptr<ProgramStream> stream;  //< the program being parsed, when streaming
         std::shared_ptr<Parser> parser;  //< the parser
         bool verbose = false;  //< whether we want verbose logging
+        EngineKind engine = EngineKind::VM;  //< the engine running the program
+        OptLevel opt_level = OptLevel::O1;  //< optimizations applied before running the program
+        ParseMode parse_mode = ParseMode::WHOLE;  //< whether the program is parsed up front
+        BodyParsing body_parsing = BodyParsing::EAGER;  //< whether function bodies are parsed up front
+        std::optional<ProgramCache> cache;  //< the precompiled program, if caching is enabled
+
+        /**
+         * @brief print and optimize a freshly parsed function or function body, as requested
+         */
+        void prepare(const Function &func) const;
+
+        /**
+         * @brief limit the depth of nested calls in the engine running the program
+         */
+        void set_max_depth(size_t depth);
+
+        /**
+         * @brief run the program in the given mode, returning the value of `main`
+         */
+        auto run_whole() -> ValType;
+        auto run_stream() -> ValType;
 
         InterpreterVisitor interpreter;  //< the interpreter
+        VirtualMachine vm;  //< the bytecode virtual machine
 
     public:
         /**
          * @brief construct the interpreter and initialize its components
          *
-         * From::FILE will be assumed
+         * From::FILE will be assumed. With a `cache_file`, the parsed program is stored in it and
+         * reused by later runs over the same source, see `ProgramCache`. A non-zero `max_depth`
+         * overrides the engine's limit of nested calls.
          */
-        TKOMInterpreter(const std::string& filename, BuiltinVector builtins, bool verbose = false);
+        TKOMInterpreter(const std::string& filename, BuiltinVector builtins, bool verbose = false,
+                        EngineKind engine = EngineKind::VM, OptLevel opt_level = OptLevel::O1,
+                        ParseMode parse_mode = ParseMode::WHOLE,
+                        BodyParsing body_parsing = BodyParsing::EAGER,
+                        const std::string& cache_file = "", size_t max_depth = 0);
 
         /**
          * @brief construct the interpreter and initialize its components
          *
          * Specify the input source
          */
-        TKOMInterpreter(const std::string& program, From from, BuiltinVector builtins, bool verbose = false);
+        TKOMInterpreter(const std::string& program, From from, BuiltinVector builtins, bool verbose = false,
+                        EngineKind engine = EngineKind::VM, OptLevel opt_level = OptLevel::O1,
+                        ParseMode parse_mode = ParseMode::WHOLE,
+                        BodyParsing body_parsing = BodyParsing::EAGER,
+                        const std::string& cache_file = "", size_t max_depth = 0);
         auto process() -> int;
 };
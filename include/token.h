@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <variant>
 
 #include "position.h"
@@ -9,13 +11,21 @@
 
 using ValueType = std::variant<std::monostate, std::string, int, double, bool>;
 
+/**
+ * @brief value carried by a token, text is not owned by the token
+ */
+using TokenValue = std::variant<std::monostate, std::string_view, int, double, bool>;
+
 /**
  * @brief class representing a single token
+ *
+ * The text of identifiers and string literals points into the source document (or, for literals
+ * with escape sequences, into the tokenizer), so a token must not outlive the lexer producing it.
  */
 class Token {
    private:
     TokenType type;  //< the type of the token
-    ValueType value;  //< the value of the token
+    TokenValue value;  //< the value of the token
     Position position;  //< the position of the token
 
    public:
@@ -27,18 +37,32 @@ class Token {
 
     /**
      * @brief get the value of a token
+     *
+     * Text can be requested either as a `std::string_view` or as an owned `std::string`
      */
     template <typename T>
     [[nodiscard]] auto get_value() const -> T {
-        return std::get<T>(value);
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string(std::get<std::string_view>(value));
+        } else {
+            return std::get<T>(value);
+        }
+    }
+
+    /**
+     * @brief get the text of an identifier or a string literal, without copying it
+     */
+    [[nodiscard]] auto get_text() const -> std::string_view {
+        return std::get<std::string_view>(value);
     }
 
     /**
-     * @brief get the value of the token as a `std::variant` (`ValueType`)
+     * @brief get the value of the token as a `std::variant` (`ValueType`), copying its text
      */
     [[nodiscard]] auto get_value() const -> ValueType;
     template <typename T>
     void set_value(T new_value) {
+        static_assert(!std::is_same_v<T, std::string>, "tokens do not own their text");
         value = new_value;
     }
 
@@ -1,26 +1,54 @@
 #pragma once
 
-#include <map>
-#include <unordered_map>
-#include <optional>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <string_view>
 
 #include "input_manager.h"
 #include "token.h"
 
 using MapTokenType = std::variant<std::monostate, TokenType>;
-using OptToken = std::optional<Token>;
+
+/**
+ * @brief the role a character can play at the start of a token
+ */
+enum class CharClass : uint8_t {
+    INVALID,         //< the character cannot start a token
+    SPACE,           //< whitespace, skipped between tokens
+    LETTER,          //< the start of an identifier or a keyword
+    DIGIT,           //< the start of a number
+    QUOTE,           //< the start of a string literal
+    OPERATOR,        //< a complete operator, which may still be extended
+    OPERATOR_START,  //< the first character of an operator that must be extended
+};
+
+/**
+ * @brief a keyword stored in the keyword hash table
+ */
+struct Keyword {
+    std::string_view text;  //< the keyword itself, empty for unused slots
+    TokenType type;  //< the token type for the keyword
+};
 
 /**
  * @brief class representing the main part of the lexical analyzer
+ *
+ * The first character of a token selects its builder through a character class table. Runs of
+ * identifier characters, blanks and string bodies are skipped in bulk, see `char_scan.h`.
  */
 class Tokenizer {
    private:
-    static const std::unordered_map<std::string, TokenType> keyword_tokens;  //< map keyword to token types
-    static const std::unordered_map<char, TokenType> first_char_tokens;  //< map first characters of operators
-    static const std::unordered_map<char, TokenType> operator_tokens;  //< map short operators
-    static const std::map<std::pair<char, TokenType>, TokenType> long_operator_tokens;  //< map long operators
+    static constexpr ptrdiff_t identifier_length_limit = 32;  //< identifiers must be shorter than this
+    static constexpr size_t keyword_slots = 32;  //< size of the keyword hash table, a power of two
+
+    static const std::array<Keyword, keyword_slots> keyword_tokens;  //< perfect hash table of keywords
+    static const std::array<CharClass, 256> char_classes;  //< map first characters to their class
+    static const std::array<TokenType, 256> operator_tokens;  //< map first characters to operators
 
     std::shared_ptr<InputManager> input;  //< the input manager, tracking the position in the source document
+    std::deque<std::string> unescaped;  //< string literals with escape sequences, tokens refer to them
+    size_t token_offset = 0;  //< offset of the first character of the last token in the document
 
     /**
      * @brief start building a token at the given position
@@ -33,59 +61,45 @@ class Tokenizer {
     auto start_build_token(Position& pos) -> Token;
 
     /**
-     * @brief attempt to create a token from the given character
+     * @brief create a token starting with the given character
      *
-     * Try to build each token going through the possible ones one-by-one
-     * Throw if none of the builders return a valid token
+     * Dispatch to the builder for the class of the character, throw if no token starts with it
      *
      * @param current_char the character from which the token starts
      */
     auto build_token(char current_token) -> Token;
 
     /**
-     * @brief try building an identifier token consisting of alphanumeric chars and '_'
-     *
-     * The character must be an alphanumeric char or '_'
-     *
-     * @param current_char the character from which the token starts
-     */
-    [[nodiscard]] auto build_identifier(char current_char) const -> OptToken;
-
-    /**
-     * @brief try building a number, integer or float
+     * @brief build an identifier or keyword token consisting of alphanumeric chars and '_'
      *
-     * The character must be a non-zero digit
-     *
-     * @param current_char the character from which the token starts
+     * The first letter must have just been read
      */
-    [[nodiscard]] auto build_number(char current_char) const -> OptToken;
+    [[nodiscard]] auto build_identifier() const -> Token;
 
     /**
-     * @brief try building a string
+     * @brief build a number, integer or float
      *
-     * The character must be a '"'
+     * The character must be a digit
      *
      * @param current_char the character from which the token starts
      */
-    [[nodiscard]] auto build_string(char current_char) const -> OptToken;
+    [[nodiscard]] auto build_number(char current_char) const -> Token;
 
     /**
-     * @brief try building a short operator
+     * @brief build a string
      *
-     * The character must be a valid one-char-long operator
-     *
-     * @param current_char the character from which the token starts
+     * The opening '"' must have just been read
      */
-    [[nodiscard]] auto build_short_operator(char current_char) const -> OptToken;
+    [[nodiscard]] auto build_string() -> Token;
 
     /**
-     * @brief try building a multi-character operator
+     * @brief build a multi-character operator
      *
      * The character must be a valid first-character of a long operator
      *
      * @param current_char the character from which the token starts
      */
-    [[nodiscard]] auto start_build_long_operator(char current_char) const -> OptToken;
+    [[nodiscard]] auto start_build_long_operator(char current_char) const -> Token;
 
     /**
      * @brief continue building a long operator
@@ -94,29 +108,31 @@ class Tokenizer {
      *
      * @param type the type of the operator which we will extend
      */
-    [[nodiscard]] auto build_long_operator(TokenType type) const -> OptToken;
+    [[nodiscard]] auto build_long_operator(TokenType type) const -> Token;
 
     /**
-     * @brief get the token type for a short operator represented by a given char
-     */
-    [[nodiscard]] auto get_type_for_operator(char c) const -> MapTokenType;
-
-    /**
-     * @brief get the token type for a start of a long operator represented by a given char
+     * @brief get the continuation of a currently built operator, for a given char
+     *
+     * @param type the type of the token we are extending
      */
-    [[nodiscard]] auto get_type_for_first_op_char(char c) const -> MapTokenType;
+    [[nodiscard]] static auto get_type_for_long_op(char c, TokenType type) -> MapTokenType;
 
     /**
-     * @brief get the continuation of a currently built operator, for a given char
+     * @brief hash a keyword candidate into the keyword table
      *
-     * @param type the type of the token we are extending
+     * The hash is perfect for the keyword set, so a single comparison decides whether a string is
+     * a keyword
      */
-    [[nodiscard]] auto get_type_for_long_op(char c, TokenType type) const -> MapTokenType;
+    [[nodiscard]] static constexpr auto keyword_hash(std::string_view value) -> size_t {
+        return (value.size() + static_cast<unsigned char>(value.front()) +
+                3 * static_cast<unsigned char>(value.back())) &
+               (keyword_slots - 1);
+    }
 
     /**
      * @brief get the keyword token type for a keyword
      */
-    [[nodiscard]] auto get_keyword_for_string(std::string value) const -> MapTokenType;
+    [[nodiscard]] static auto get_keyword_for_string(std::string_view value) -> MapTokenType;
 
     /**
      * @brief get the char for an escape
@@ -132,4 +148,9 @@ class Tokenizer {
      * Continue parsing the file until a full token is built, then return the token
      */
     auto get_token() -> Token;
+
+    /**
+     * @brief get the offset of the last token's first character in the source document
+     */
+    [[nodiscard]] auto get_token_offset() const -> size_t { return token_offset; }
 };
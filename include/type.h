@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "node.h"
+#include "node_view.h"
 #include "tokens.h"
 
 class Visitor;
@@ -58,7 +59,7 @@ class Type : public Node {
     /**
      * @brief function returning the parameters of a function type
      */
-    [[nodiscard]] virtual auto get_params() const -> std::vector<const Type *> = 0;
+    [[nodiscard]] virtual auto get_params() const -> NodeView<Type> = 0;
 
     /**
      * @brief function returning the return type of a function, or VarType for variables
@@ -113,7 +114,7 @@ class VarType : public Type {
     /**
      * @brief function returning the parameters of a function type
      */
-    [[nodiscard]] auto get_params() const -> std::vector<const Type *> override {
+    [[nodiscard]] auto get_params() const -> NodeView<Type> override {
         throw std::runtime_error("Variable type does not contain parameters");
     }
     [[nodiscard]] auto get_ret_type() const -> const Type * override { return this; }
@@ -155,7 +156,7 @@ class FuncType : public Type {
     /**
      * @brief get the parameters of a function
      */
-    [[nodiscard]] auto get_params() const -> std::vector<const Type *> override;
+    [[nodiscard]] auto get_params() const -> NodeView<Type> override { return node_view(params); }
 
     /**
      * @brief check if a function type is equal to another
@@ -0,0 +1,86 @@
+#pragma once
+/**
+ * @file value_stack.h
+ *
+ * Chunked storage for the variables of all active frames
+ */
+
+#include <optional>
+#include <vector>
+
+#include "interpreter_helpers.h"
+
+/**
+ * @brief stack of variables, stored inline
+ *
+ * Variables live in chunks that are allocated as the stack grows and never reallocated, so
+ * pointers to variables (references passed to callees, slot pointers of the VM) stay valid until
+ * the variable is popped. Chunks emptied by popping are kept for reuse. How deep the stack may
+ * grow is up to the engine's limit of nested calls.
+ */
+class ValueStack {
+   private:
+    /**
+     * @brief a contiguous run of the stack
+     */
+    struct Chunk {
+        size_t base;                   //< index of the chunk's first variable
+        std::vector<Variable> values;  //< the variables, reserved once and never reallocated
+    };
+    std::vector<Chunk> chunks = std::vector<Chunk>(1);  //< chunks in order, empty above `top`
+    size_t top = 0;   //< index of the chunk holding the innermost variable
+    size_t used = 0;  //< number of variables on the stack
+
+    /**
+     * @brief make room for `needed` variables in one chunk, moving on to the next one if needed
+     */
+    auto reserve(size_t needed) -> Chunk &;
+
+    /**
+     * @brief find the index of a variable, if it is on the stack at or above `from`
+     */
+    [[nodiscard]] auto index_of(const Variable *var, size_t from) const -> std::optional<size_t>;
+
+   public:
+    static constexpr size_t chunk_size = 1 << 12;  //< number of variables in a regular chunk
+
+    /**
+     * @brief push a variable, returning its stable address
+     */
+    auto push(Variable var) -> Variable *;
+
+    /**
+     * @brief push `count` empty variables, stored next to each other
+     *
+     * @return the first of the pushed variables
+     */
+    auto grow(size_t count) -> Variable *;
+
+    /**
+     * @brief pop all variables above the given size
+     */
+    void truncate(size_t size);
+
+    /**
+     * @brief pop all variables above the given size, except for the ones the arguments refer to
+     *
+     * The referenced variables are moved down right above `size`, in their original order, and
+     * the arguments are pointed at their new addresses. Used to release a frame whose variables
+     * are passed on to a tail call.
+     */
+    void truncate_keeping(size_t size, ArgVector &args);
+
+    [[nodiscard]] auto size() const -> size_t { return used; }
+    auto back() -> Variable & { return chunks[top].values.back(); }
+
+    /**
+     * @brief get the variable at the given index
+     *
+     * The variables of a frame usually share the innermost chunk, which is checked first.
+     */
+    auto operator[](size_t index) -> Variable & {
+        size_t chunk = top;
+        while (chunks[chunk].base > index) --chunk;
+        return chunks[chunk].values.data()[index - chunks[chunk].base];
+    }
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief location of a variable inside a call stack frame
+ *
+ * Assigned to identifiers and assignments by the `Resolver`. Depth 0 refers to the function's
+ * parameters, depth n to the n-th nested block scope of the function.
+ */
+struct VarSlot {
+    uint32_t depth;  //< scope the variable lives in
+    uint32_t slot;   //< index of the variable within its scope
+};
@@ -8,14 +8,14 @@ class Visitor;
 /**
  * @brief class representing a variable's signature in the syntax tree
  */
-class VariableSignature {
+class VariableSignature : public ArenaAllocated {
     std::unique_ptr<Type> type;  //< the variable's type
-    const std::string name;  //< the variable's name
+    const Symbol name;  //< the variable's name
     Position pos;  //< the variable's position in code
 
    public:
-    VariableSignature(std::unique_ptr<Type> type, std::string name);
-    VariableSignature(std::unique_ptr<Type> type, std::string name, Position pos);
+    VariableSignature(std::unique_ptr<Type> type, Symbol name);
+    VariableSignature(std::unique_ptr<Type> type, Symbol name, Position pos);
 
     void accept(Visitor &visitor) const;
 
@@ -27,5 +27,15 @@ class VariableSignature {
     /**
      * @brief get the name of the variable
      */
-    [[nodiscard]] auto get_name() const -> const std::string;
+    [[nodiscard]] auto get_name() const -> const std::string & { return name.str(); }
+
+    /**
+     * @brief get the interned name of the variable
+     */
+    [[nodiscard]] auto get_symbol() const -> Symbol { return name; }
+
+    /**
+     * @brief get the position of the variable in code
+     */
+    [[nodiscard]] auto get_position() const -> Position { return pos; }
 };
@@ -0,0 +1,149 @@
+#pragma once
+/**
+ * @file vm.h
+ *
+ * The register-based bytecode virtual machine
+ */
+
+#include <unordered_map>
+
+#include "bytecode.h"
+#include "engine.h"
+#include "function_table.h"
+#include "program.h"
+#include "program_stream.h"
+#include "value_stack.h"
+
+/**
+ * @brief Virtual machine executing compiled functions
+ *
+ * Functions are compiled into bytecode on their first call. All frames share contiguous stacks
+ * of registers, local variable slots and variable storage, each frame owning a window starting
+ * at its base offset. A slot points either to the frame's own storage or, for parameters passed
+ * by reference, to a variable of the caller.
+ *
+ * Calls between user-defined functions do not recurse on the native stack: the caller's state is
+ * saved on a stack of frames and the callee runs in the same dispatch loop, so the depth of
+ * nested calls is only bounded by a configurable limit.
+ *
+ * The machine behaves exactly like `InterpreterVisitor` - it shares its callables, casting rules
+ * and error messages, so both engines can be used interchangeably.
+ */
+class VirtualMachine : public Engine {
+   public:
+    static constexpr size_t default_max_depth = 1 << 16;  //< default maximal depth of nested calls
+    // deeper limits cannot be reached before running out of memory
+    static constexpr size_t max_depth_limit = 1 << 24;  //< largest depth that may be requested
+
+   private:
+    /**
+     * @brief the state of a caller, saved while its callee runs
+     */
+    struct Frame {
+        const Chunk *chunk;                  //< the caller's code
+        const Instruction *ip;               //< the call instruction, receiving the returned value
+        size_t reg_base;                     //< the caller's window of registers
+        size_t local_base;                   //< the caller's window of local slots
+        size_t value_base;                   //< the caller's window of the value stack
+        Variable *storage;                   //< the caller's variable storage
+        const GlobalFunction *callee;        //< the called function, casting the returned value
+        GlobalFunction *tail_target;         //< the caller's last tail call, if any
+        Position tail_site;                  //< the position of the caller's last tail call
+    };
+
+    FunctionTable functions;  //< available global functions (either user-defined or built-in)
+    std::unordered_map<const Function *, std::unique_ptr<Chunk>>
+        chunks;  //< compiled functions, by their syntax tree
+    std::vector<ValType> registers;                 //< registers of all active frames
+    std::vector<Variable *> locals;                 //< local variable slots of all active frames
+    ValueStack values;                              //< variables owned by all active frames
+    std::vector<Frame> frames;  //< callers waiting for their callees to return
+    ArgVector call_args;        //< arguments of the call being made, reused by all calls
+    size_t depth = 0;           //< number of active frames
+    size_t max_depth = default_max_depth;  //< maximal number of active frames
+    ValType current_value;                          //< value returned by the last function
+    bool verbose = false;  //< whether to print the bytecode of compiled functions
+
+    /**
+     * @brief register a new global function
+     */
+    void register_function(const Function *func);
+
+    /**
+     * @brief get the compiled form of a function, compiling it if needed
+     */
+    auto get_chunk(const Function &func) -> const Chunk &;
+
+    /**
+     * @brief bind the arguments to the first local slots of a frame, storing values in the frame
+     */
+    void bind_args(const Function &func, ArgVector &args, Variable **local, Variable *storage);
+
+    /**
+     * @brief execute a chunk within the frame starting at the given offsets
+     *
+     * Calls to user-defined functions push a frame and continue in the callee's chunk, returning
+     * once the entry chunk returns. Tail calls to functions returning the same type replace the
+     * chunk and reuse the frame instead, so tail recursion runs in constant space.
+     */
+    void execute(const Chunk &chunk, size_t reg_base, size_t local_base, size_t value_base);
+
+   public:
+    VirtualMachine() = default;
+
+    /**
+     * @brief construct with a vector of builtin functions
+     */
+    VirtualMachine(std::vector<std::shared_ptr<Callable>> builtins, bool verbose = false);
+
+    /**
+     * @brief limit the depth of nested calls, before running a program
+     *
+     * Calls nested any deeper raise an error at the call site.
+     */
+    void set_max_depth(size_t depth);
+
+    /**
+     * @brief register the program's functions and call `main`
+     */
+    void run(const Program &program);
+
+    /**
+     * @brief call `main` as soon as it is parsed, parsing the other functions as they are needed
+     *
+     * Functions are compiled on their first call, so a function is parsed at the latest when a
+     * function referring to it is compiled. The rest of the program is parsed after `main`
+     * returns, so that its errors are still reported.
+     */
+    void run(ProgramStream &stream);
+
+    /**
+     * @brief find a global function with a given name, parsing it first when streaming
+     */
+    auto find_func(const std::string &name) -> std::shared_ptr<Callable>;
+
+    /**
+     * @brief return the current value
+     */
+    [[nodiscard]] auto get_value() const -> ValType override;
+
+    /**
+     * @brief override the current value
+     */
+    void override_value(ValType val) override;
+
+    /**
+     * @brief initialize a variable with a given type
+     */
+    auto init_var(const Type &type) -> ValType override;
+
+    /**
+     * @brief bind the arguments to the function's local slots and execute its bytecode
+     */
+    void run_function(const Function &func, ArgVector &args) override;
+
+    /**
+     * @brief resolve a function against the global functions
+     */
+    void resolve(const Function &func) override;
+};
@@ -1,27 +1,24 @@
 #include "input_manager.h"
 
+#include <algorithm>
+#include <cstring>
 #include <istream>
 #include <utility>
 
 InputManager::InputManager(std::shared_ptr<Position> position, std::shared_ptr<std::istream> input)
-    : position(std::move(position)), input_stream(std::move(input)) {}
-
-auto InputManager::get_next_char() -> char {
-    if (handed_back) {
-        handed_back = false;
-        return last_char;
-    }
-
-    last_char = input_stream->get();
-
-    if (last_char == '\r' and input_stream->peek() == '\n') {
-        last_char = input_stream->get();
-    } else if (last_char == EOF) {
-        eof = true;
-    }
-
-    position->adjust_position(last_char);
-    return last_char;
+    : InputManager(std::move(position), SourceBuffer::from_stream(*input)) {}
+
+InputManager::InputManager(std::shared_ptr<Position> position,
+                           std::shared_ptr<const SourceBuffer> source)
+    : position(std::move(position)),
+      source(std::move(source)),
+      cursor(this->source->data()),
+      limit(this->source->data() + this->source->size()) {}
+
+InputManager::InputManager(std::shared_ptr<Position> position,
+                           std::shared_ptr<const SourceBuffer> source, size_t offset)
+    : InputManager(std::move(position), std::move(source)) {
+    cursor += std::min(offset, this->source->size());
 }
 
 auto InputManager::save_position() const -> Position { return *position; }
@@ -31,6 +28,14 @@ void InputManager::unget() { handed_back = true; }
 auto InputManager::end() const -> bool { return eof; }
 
 void InputManager::skip_line() {
+    if (last_char == '\n' || last_char == EOF) return;
+
+    // jump right before the line break, the rest of the line only moves the column
+    if (!handed_back) {
+        const auto* newline =
+            static_cast<const char*>(std::memchr(cursor, '\n', limit - cursor));
+        if (newline) cursor = newline;
+    }
     while (last_char != '\n' && last_char != EOF) {
         get_next_char();
     }
@@ -0,0 +1,59 @@
+#include "source_buffer.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TKOM_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::~SourceBuffer() {
+#ifdef TKOM_MMAP
+    if (mapping) munmap(mapping, length);
+#endif
+}
+
+auto SourceBuffer::from_file(const std::string& filename) -> std::shared_ptr<const SourceBuffer> {
+#ifdef TKOM_MMAP
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info {};
+        void* mapping = MAP_FAILED;
+        // pipes and empty files cannot be mapped
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+            std::shared_ptr<SourceBuffer> source(new SourceBuffer());
+            source->mapping = mapping;
+            source->begin = static_cast<const char*>(mapping);
+            source->length = static_cast<size_t>(info.st_size);
+            return source;
+        }
+    }
+#endif
+    std::ifstream input(filename, std::ios::binary);
+    return from_stream(input);
+}
+
+auto SourceBuffer::from_stream(std::istream& input) -> std::shared_ptr<const SourceBuffer> {
+    static constexpr size_t chunk_size = 1 << 16;
+
+    std::shared_ptr<SourceBuffer> source(new SourceBuffer());
+    auto& storage = source->storage;
+    while (input) {
+        const size_t used = storage.size();
+        storage.resize(used + chunk_size);
+        input.read(storage.data() + used, chunk_size);
+        storage.resize(used + static_cast<size_t>(input.gcount()));
+    }
+    source->begin = storage.data();
+    source->length = storage.size();
+    return source;
+}
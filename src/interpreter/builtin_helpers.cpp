@@ -1,18 +1,12 @@
 #include "builtin_helpers.h"
 #include "interpreter_shall.h"
-
-template <typename... Ts>
-struct Overload : Ts... {
-    using Ts::operator()...;
-};
-template <class... Ts>
-Overload(Ts...) -> Overload<Ts...>;
+#include "overload.h"
 
 /**
  * @brief modify the value of a variable depending on if it is a reference or not
  */
 void modify_value(Arg& arg, ValType value) {
-    std::visit(Overload{[value](std::shared_ptr<Variable> var) { var->value = value; },
+    std::visit(Overload{[value](Variable* var) { var->value = value; },
                         [value](ValType var) { var = value; }},
                arg);
 }
@@ -21,7 +15,7 @@ void modify_value(Arg& arg, ValType value) {
  * @brief get the value of a variable depending on if it is a reference or not
  */
 auto get_value(Arg& arg) -> ValType {
-    return std::visit(Overload{[](std::shared_ptr<Variable> var) { return var->value; },
+    return std::visit(Overload{[](Variable* var) { return var->value; },
                                [](ValType var) { return var; }},
                       arg);
 }
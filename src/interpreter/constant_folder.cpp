@@ -0,0 +1,132 @@
+#include "constant_folder.h"
+
+#include <utility>
+
+#include "arithmetics.h"
+
+/**
+ * @brief convert a computed value back into a literal, empty for values literals cannot hold
+ */
+static auto to_literal(const ValType& value) -> std::optional<ValueType> {
+    if (const auto* string = std::get_if<std::string>(&value)) return *string;
+    if (const auto* integer = std::get_if<int>(&value)) return *integer;
+    if (const auto* floating = std::get_if<double>(&value)) return *floating;
+    if (const auto* boolean = std::get_if<bool>(&value)) return *boolean;
+    return std::nullopt;
+}
+
+/**
+ * @brief check whether evaluating the operator would divide an integer by zero
+ *
+ * Such a program only crashes if the expression is executed, so it must not be folded
+ */
+static auto divides_by_zero(BinaryOp op, const ValType& left, const ValType& right) -> bool {
+    if (op != BinaryOp::DIV) return false;
+    const bool integral = !std::holds_alternative<double>(left) &&
+                          !std::holds_alternative<double>(right);
+    const bool zero = std::visit(
+        [](const auto& v) {
+            if constexpr (std::is_arithmetic_v<std::decay_t<decltype(v)>>) return v == 0;
+            return false;
+        },
+        right);
+    return integral && zero;
+}
+
+auto ConstantFolder::fold(const Expression* expr) -> std::optional<ValType> {
+    constant = std::nullopt;
+    expr->accept(*this);
+    return std::exchange(constant, std::nullopt);
+}
+
+void ConstantFolder::visit(const Program& program) {
+    for (const auto* func : program.get_functions()) func->accept(*this);
+}
+
+void ConstantFolder::visit(const Function& func) {
+    if (const auto* body = func.get_body()) body->accept(*this);
+}
+
+void ConstantFolder::visit(const Block& block) {
+    for (const auto* stmt : block.get_statements()) stmt->accept(*this);
+}
+
+void ConstantFolder::visit(const LiteralExpr& expr) { constant = literal_value(expr.get_value()); }
+
+void ConstantFolder::visit(const IdentifierExpr& expr) {
+    (void)expr;
+    constant = std::nullopt;
+}
+
+void ConstantFolder::visit(const UnaryExpr& expr) {
+    auto right = fold(expr.get_right());
+    if (!right) return;
+
+    try {
+        constant = apply_unary_op(expr.get_operator(), *right);
+    } catch (InterpreterError&) {
+        constant = std::nullopt;
+        return;
+    }
+    expr.set_folded(to_literal(*constant));
+    if (!expr.get_folded()) constant = std::nullopt;
+}
+
+void ConstantFolder::visit(const BinaryExpr& expr) {
+    // fold both sides, even if the other one turns out not to be constant
+    auto right = fold(expr.get_right());
+    auto left = fold(expr.get_left());
+    if (!left || !right || divides_by_zero(expr.get_operator(), *left, *right)) return;
+
+    try {
+        constant = apply_binary_op(expr.get_operator(), *left, *right);
+    } catch (InterpreterError&) {
+        constant = std::nullopt;
+        return;
+    }
+    expr.set_folded(to_literal(*constant));
+    if (!expr.get_folded()) constant = std::nullopt;
+}
+
+void ConstantFolder::visit(const CallExpr& expr) {
+    expr.get_func_name()->accept(*this);
+    for (const auto* arg : expr.get_args()) arg->accept(*this);
+    constant = std::nullopt;
+}
+
+void ConstantFolder::visit(const BindFrtExpr& expr) {
+    expr.get_func_name()->accept(*this);
+    for (const auto* arg : expr.get_args()) arg->accept(*this);
+    constant = std::nullopt;
+}
+
+void ConstantFolder::visit(const AssignStatement& stmt) { stmt.get_value()->accept(*this); }
+
+void ConstantFolder::visit(const ForLoopStatement& stmt) {
+    const auto& args = *stmt.get_args();
+    if (const auto* iterator = std::get_if<std::unique_ptr<Statement>>(&args.iterator)) {
+        (*iterator)->accept(*this);
+    }
+    stmt.get_on_iter()->accept(*this);
+    args.condition->accept(*this);
+    stmt.get_body()->accept(*this);
+}
+
+void ConstantFolder::visit(const WhileLoopStatement& stmt) {
+    stmt.get_condition()->accept(*this);
+    stmt.get_body()->accept(*this);
+}
+
+void ConstantFolder::visit(const ConditionalStatement& stmt) {
+    stmt.get_condition()->accept(*this);
+    stmt.get_body()->accept(*this);
+    if (const auto* else_st = stmt.get_else_st()) else_st->accept(*this);
+}
+
+void ConstantFolder::visit(const ElseStatement& stmt) { stmt.get_body()->accept(*this); }
+
+void ConstantFolder::visit(const RetStatement& stmt) {
+    if (const auto* retval = stmt.get_retval()) retval->accept(*this);
+}
+
+void ConstantFolder::visit(const CallStatement& stmt) { stmt.get_call()->accept(*this); }
@@ -0,0 +1,52 @@
+#include "function_table.h"
+
+#include "exceptions.h"
+#include "program_stream.h"
+#include "resolver.h"
+
+FunctionTable::FunctionTable(const std::vector<std::shared_ptr<Callable>>& builtins) {
+    for (const auto& func : builtins) add(func);
+}
+
+auto FunctionTable::add(std::shared_ptr<Callable> func) -> bool {
+    const Symbol name(func->get_name());
+    return functions.try_emplace(name, std::move(func)).second;
+}
+
+auto FunctionTable::find(Symbol name) const -> std::shared_ptr<Callable> {
+    auto func = functions.find(name);
+    if (func == functions.end()) return nullptr;
+    return func->second;
+}
+
+auto FunctionTable::find(const std::string& name) const -> std::shared_ptr<Callable> {
+    auto symbol = Symbol::find(name);
+    return symbol ? find(*symbol) : nullptr;
+}
+
+void FunctionTable::stream_from(ProgramStream* source) { stream = source; }
+
+auto FunctionTable::load_next() -> bool {
+    const Function* func = stream ? stream->next() : nullptr;
+    if (!func) return false;
+
+    if (!add(std::make_shared<GlobalFunction>(func))) {
+        throw GeneralError(func->get_position(),
+                           "Attempted to re-define " + func->get_signature()->get_name());
+    }
+    // call sites of functions not parsed yet stay unbound, they are looked up when executed
+    Resolver resolver(this);
+    func->accept(resolver);
+    return true;
+}
+
+auto FunctionTable::load(Symbol name) -> std::shared_ptr<Callable> {
+    auto func = find(name);
+    while (!func && load_next()) func = find(name);
+    return func;
+}
+
+void FunctionTable::load_all() {
+    while (load_next()) {
+    }
+}
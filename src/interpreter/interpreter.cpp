@@ -4,9 +4,10 @@
 #include <utility>
 
 #include "interpreter_shall.h"
+#include "resolver.h"
 
 InterpreterVisitor::InterpreterVisitor(std::vector<std::shared_ptr<Callable>> builtins)
-    : functions(std::move(builtins)) {}
+    : functions(builtins) {}
 
 void InterpreterVisitor::visit(const Program& program) {
     for (const auto& fn : program.get_functions()) {
@@ -16,56 +17,92 @@ void InterpreterVisitor::visit(const Program& program) {
             throw GeneralError(fn->get_position(), e.what());
         }
     }
+
+    Resolver resolver(&functions);
+    program.accept(resolver);
+
     auto main = find_func("main");
-    main->call(*this, {});
+    ArgVector main_args;
+    locate_errors([&] { main->call(*this, main_args); });
+}
+
+void InterpreterVisitor::run(ProgramStream& stream) {
+    functions.stream_from(&stream);
+
+    auto main = find_func("main");
+    shall(main, "Missing main function");
+    ArgVector main_args;
+    locate_errors([&] { main->call(*this, main_args); });
+
+    functions.load_all();
 }
 
 void InterpreterVisitor::visit(const Function& func) {
     try_visit(func.get_body());
-    if (returning) returning = false;
+    completion = Completion::NORMAL;
 }
 
 void InterpreterVisitor::visit(const Block& block) {
-    call_stack.back().var_scope.emplace_back();
-    for (auto& stmt : block.get_statements()) {
+    push_scope();
+    run_statements(block);
+    pop_scope();
+}
+
+void InterpreterVisitor::run_statements(const Block& block) {
+    for (const auto* stmt : block.get_statements()) {
         try_visit(stmt);
-        if (returning) break;
+        if (completion != Completion::NORMAL) break;
     }
-    call_stack.back().var_scope.pop_back();
 }
 
 void InterpreterVisitor::visit(const CallExpr& expr) {
-    ArgVector args;
+    const bool tail = std::exchange(tail_position, false);
     try_visit(expr.get_func_name());
     auto func = current_value;
 
-    for (auto& arg : expr.get_args()) {
+    // the only allocation of the call, with room for the arguments bound by the callee
+    ArgVector args;
+    const auto* bound = std::get_if<std::shared_ptr<Callable>>(&func);
+    args.reserve(expr.get_args().size() + (bound ? (*bound)->bound_count() : 0));
+    for (const auto* arg : expr.get_args()) {
         try_visit(arg);
         // we got a identifier expression, pass by ref
         if (receiver == ReceivedBy::VAR) {
-            auto var_ptr = var;
-            args.emplace_back(var_ptr.lock());
+            args.emplace_back(var);
             // we got a standard expression, we will pass by value
         } else {
             args.emplace_back(current_value);
         }
     }
-    std::get<std::shared_ptr<Callable>>(func)->call(*this, args);
+    receiver = ReceivedBy::EXPR;
+    const auto& callee = std::get<std::shared_ptr<Callable>>(func);
+    if (tail && defer_tail_call(callee, args, expr.get_position())) return;
+    callee->call(*this, args);
     receiver = ReceivedBy::EXPR;
 }
 
 void InterpreterVisitor::visit(const IdentifierExpr& expr) {
-    std::weak_ptr<Variable> found = find_var_in_frame(expr.get_identifier());
+    // only variables can be passed by reference, global functions are plain values
+    receiver = ReceivedBy::EXPR;
 
-    if (auto var_val = found.lock()) {
-        current_value = var_val->value;
+    // global functions bound by the resolver need no lookup
+    if (auto bound = expr.get_function()) {
+        current_value = std::move(bound);
+        return;
+    }
+
+    auto slot = expr.get_slot();
+    Variable* found = slot ? get_var(*slot) : find_var_in_frame(expr.get_symbol());
+
+    if (found) {
+        current_value = found->value;
         var = found;
+        receiver = ReceivedBy::VAR;
     } else {
-        auto func = find_func(expr.get_identifier());
+        auto func = find_func(expr.get_symbol());
         shall(func, "Unknown identifier");
         current_value = func;
     }
-    receiver = ReceivedBy::VAR;
 }
 
 void InterpreterVisitor::visit(const AssignStatement& stmt) {
@@ -73,12 +110,17 @@ void InterpreterVisitor::visit(const AssignStatement& stmt) {
     ValType value = current_value;
 
     auto type = stmt.get_type();
-    const std::string identifier = stmt.get_identifier();
+    const Symbol identifier = stmt.get_symbol();
 
     if (!type) {
-        modify_var(identifier);
+        modify_var(identifier, stmt.get_slot());
     } else {
-        shall(!find_var_in_frame(identifier).lock(), "Variable " + identifier + " is already defined in this frame");
+        // resolved declarations are known not to clash with another variable
+        if (!stmt.get_slot()) {
+            shall(!find_var_in_frame(identifier), [identifier] {
+                return "Variable " + identifier.str() + " is already defined in this frame";
+            });
+        }
         register_var(*stmt.get_signature());
     }
 }
@@ -88,10 +130,7 @@ void InterpreterVisitor::visit(const VarType& type) { current_type = type.get_ty
 void InterpreterVisitor::visit(const FuncType& type) { current_type = &type; }
 
 void InterpreterVisitor::visit(const WhileLoopStatement& stmt) {
-    auto condition = stmt.get_condition();
-    while (eval_condition(*condition)) {
-        try_visit(stmt.get_body());
-    }
+    run_loop(*stmt.get_condition(), *stmt.get_body(), [] {});
 }
 
 void InterpreterVisitor::visit(const ConditionalStatement& stmt) {
@@ -116,16 +155,26 @@ void InterpreterVisitor::visit(const ForLoopStatement& stmt) {
     shall(std::holds_alternative<std::shared_ptr<Callable>>(on_iter), "on iter call must be a function");
 
     auto on_iter_func = std::get<std::shared_ptr<Callable>>(on_iter);
-    ArgVector on_iter_arg = {iterator.lock()};
-
-    for (;eval_condition(*condition); on_iter_func->call(*this, on_iter_arg)){
-        try_visit(stmt.get_body());
-    }
+    ArgVector on_iter_args;
+    on_iter_args.reserve(1 + on_iter_func->bound_count());
+
+    run_loop(*condition, *stmt.get_body(), [&] {
+        // the call uses the arguments in place, they are set anew for each iteration
+        on_iter_args.assign(1, iterator);
+        on_iter_func->call(*this, on_iter_args);
+    });
 }
 
-void InterpreterVisitor::visit(const RetStatement& stmt) { 
-    try_visit(stmt.get_retval());
-    returning = true;
+void InterpreterVisitor::visit(const RetStatement& stmt) {
+    if (const auto* retval = stmt.get_retval()) {
+        // a returned call may run in place of this function, see `defer_tail_call`
+        tail_position = dynamic_cast<const CallExpr*>(retval) != nullptr;
+        try_visit(retval);
+    } else {
+        const Function& func = *call_stack.back().function;
+        current_value = default_value(*func.get_signature()->get_type()->get_ret_type());
+    }
+    completion = Completion::RETURN;
 }
 
 void InterpreterVisitor::visit(const CallStatement& stmt) {
@@ -142,16 +191,15 @@ void InterpreterVisitor::visit(const BindFrtExpr& expr) {
     // grab arguments
     // pass all by value for bindfront
     ArgVector args;
-    for (auto& arg : expr.get_args()) {
+    for (const auto* arg : expr.get_args()) {
         try_visit(arg);
         if (receiver == ReceivedBy::VAR) {
-            auto var_ptr = var;
-            args.emplace_back(var_ptr.lock()->value);
+            args.emplace_back(var->value);
         } else {
             args.emplace_back(current_value);
         }
     }
-    auto new_func = std::make_shared<LocalFunction>(func, args);
+    auto new_func = std::make_shared<LocalFunction>(func, std::move(args));
     current_type = new_func->get_type();
     current_value = std::move(new_func);
 }
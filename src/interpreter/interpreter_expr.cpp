@@ -22,74 +22,170 @@ static Unary unary_minus_v{[](auto l) -> int { return -l; }};
 static Decorate decorator_v{};
 
 void InterpreterVisitor::visit(const LiteralExpr& expr) {
-    ValueType expr_val = expr.get_value();
-
-    current_value = std::visit(
-        [](auto&& v) -> ValType { return ValType{std::forward<decltype(v)>(v)}; }, expr_val);
+    current_value = literal_value(expr.get_value());
     receiver = ReceivedBy::EXPR;
 }
 
-void InterpreterVisitor::visit(const BinaryExpr& expr) {
-    expr.get_right()->accept(*this);
-    ValType right = current_value;
-
-    expr.get_left()->accept(*this);
-    ValType left = current_value;
+/**
+ * @brief evaluate arithmetic and comparison operators on two operands of the same numeric type
+ *
+ * Mirrors the generic operators, without going through the double visitation
+ *
+ * @return false if the operator has no fast path
+ */
+template <typename T>
+static auto try_fast_binary_op(BinaryOp op, T l, T r, ValType& result) -> bool {
+    switch (op) {
+        case BinaryOp::ADD:
+            result = l + r;
+            return true;
+        case BinaryOp::SUB:
+            result = l - r;
+            return true;
+        case BinaryOp::MULT:
+            result = l * r;
+            return true;
+        case BinaryOp::LT:
+            result = l < r;
+            return true;
+        case BinaryOp::GT:
+            result = l > r;
+            return true;
+        case BinaryOp::LTE:
+            result = l <= r;
+            return true;
+        case BinaryOp::GTE:
+            result = l >= r;
+            return true;
+        case BinaryOp::EQ:
+            result = l == r;
+            return true;
+        case BinaryOp::NEQ:
+            result = l != r;
+            return true;
+        default:
+            return false;
+    }
+}
 
-    switch (expr.get_operator()) {
+/**
+ * @brief compare or concatenate two strings
+ *
+ * @return false if the operator has no fast path
+ */
+static auto try_fast_binary_op(BinaryOp op, const std::string& l, const std::string& r,
+                               ValType& result) -> bool {
+    switch (op) {
         case BinaryOp::ADD:
-            current_value = std::visit(add_v, left, right);
+            result = l + r;
+            return true;
+        case BinaryOp::EQ:
+            result = l == r;
+            return true;
+        case BinaryOp::NEQ:
+            result = l != r;
+            return true;
+        default:
+            return false;
+    }
+}
+
+auto apply_typed_binary_op(BaseType type, BinaryOp op, const ValType& left, const ValType& right)
+    -> ValType {
+    // the resolver guarantees the alternatives, no need to check them again
+    ValType result;
+    switch (type) {
+        case BaseType::INT:
+            if (try_fast_binary_op(op, *std::get_if<int>(&left), *std::get_if<int>(&right), result))
+                return result;
             break;
-        case BinaryOp::SUB:
-            current_value = std::visit(sub_v, left, right);
+        case BaseType::FLT:
+            if (try_fast_binary_op(op, *std::get_if<double>(&left), *std::get_if<double>(&right),
+                                   result))
+                return result;
             break;
-        case BinaryOp::MULT:
-            current_value = std::visit(mul_v, left, right);
+        case BaseType::STRING:
+            if (try_fast_binary_op(op, *std::get_if<std::string>(&left),
+                                   *std::get_if<std::string>(&right), result))
+                return result;
             break;
-        case BinaryOp::DIV:
-            current_value = std::visit(div_v, left, right);
+        default:
             break;
+    }
+    return apply_binary_op(op, left, right);
+}
+
+auto apply_binary_op(BinaryOp op, const ValType& left, const ValType& right) -> ValType {
+    switch (op) {
+        case BinaryOp::ADD:
+            return std::visit(add_v, left, right);
+        case BinaryOp::SUB:
+            return std::visit(sub_v, left, right);
+        case BinaryOp::MULT:
+            return std::visit(mul_v, left, right);
+        case BinaryOp::DIV:
+            return std::visit(div_v, left, right);
         case BinaryOp::LT:
-            current_value = std::visit(lt_v, left, right);
-            break;
+            return std::visit(lt_v, left, right);
         case BinaryOp::GT:
-            current_value = std::visit(gt_v, left, right);
-            break;
+            return std::visit(gt_v, left, right);
         case BinaryOp::LTE:
-            current_value = std::visit(lte_v, left, right);
-            break;
+            return std::visit(lte_v, left, right);
         case BinaryOp::GTE:
-            current_value = std::visit(gte_v, left, right);
-            break;
+            return std::visit(gte_v, left, right);
         case BinaryOp::EQ:
-            current_value = std::visit(eq_v, left, right);
-            break;
+            return std::visit(eq_v, left, right);
         case BinaryOp::NEQ:
-            current_value = std::visit(neq_v, left, right);
-            break;
+            return std::visit(neq_v, left, right);
         case BinaryOp::OR:
-            current_value = std::visit(or_v, left, right);
-            break;
+            return std::visit(or_v, left, right);
         case BinaryOp::AND:
-            current_value = std::visit(and_v, left, right);
-            break;
+            return std::visit(and_v, left, right);
         case BinaryOp::DECORATE:
-            current_value = std::visit(decorator_v, left, right);
-            break;
+            return std::visit(decorator_v, left, right);
+    }
+    throw InterpreterError("Unsupported operator");
+}
+
+auto apply_unary_op(UnaryOp op, const ValType& right) -> ValType {
+    switch (op) {
+        case UnaryOp::NOT:
+            return std::visit(unary_not_v, right);
+        case UnaryOp::MINUS:
+            return std::visit(unary_minus_v, right);
+    }
+    throw InterpreterError("Unsupported operator");
+}
+
+void InterpreterVisitor::visit(const BinaryExpr& expr) {
+    if (const auto& folded = expr.get_folded()) {
+        current_value = literal_value(*folded);
+        receiver = ReceivedBy::EXPR;
+        return;
+    }
+
+    expr.get_right()->accept(*this);
+    ValType right = current_value;
+
+    expr.get_left()->accept(*this);
+    ValType left = current_value;
+
+    if (const auto type = expr.get_operand_type()) {
+        current_value = apply_typed_binary_op(*type, expr.get_operator(), left, right);
+    } else {
+        current_value = apply_binary_op(expr.get_operator(), left, right);
     }
     receiver = ReceivedBy::EXPR;
 }
 
 void InterpreterVisitor::visit(const UnaryExpr& expr) {
+    if (const auto& folded = expr.get_folded()) {
+        current_value = literal_value(*folded);
+        return;
+    }
+
     expr.get_right()->accept(*this);
     auto left = current_value;
 
-    switch (expr.get_operator()) {
-        case UnaryOp::NOT:
-            current_value = std::visit(unary_not_v, left);
-            break;
-        case UnaryOp::MINUS:
-            current_value = std::visit(unary_minus_v, left);
-            break;
-    }
+    current_value = apply_unary_op(expr.get_operator(), left);
 }
@@ -1,103 +1,217 @@
-#include <algorithm>
-#include <ranges>
-
 #include "interpreter.h"
+
+#include <utility>
+
 #include "interpreter_shall.h"
+#include "overload.h"
+#include "resolver.h"
 #include "type_cast.h"
 
 void InterpreterVisitor::register_function(const Function* func) {
-    std::string name = func->get_signature()->get_name();
-    shall(!find_func(name), "Attempted to re-define " + name);
-    auto func_ptr = std::make_shared<GlobalFunction>(func);
-    functions.push_back(std::move(func_ptr));
+    shall(functions.add(std::make_shared<GlobalFunction>(func)),
+          [func] { return "Attempted to re-define " + func->get_signature()->get_name(); });
 }
 
 auto InterpreterVisitor::get_value() const -> ValType { return current_value; }
 
 void InterpreterVisitor::override_value(ValType val) { current_value = val; }
 
-void InterpreterVisitor::push_call_stack(CallStackFrame frame) { call_stack.push_back(frame); }
+void InterpreterVisitor::set_max_depth(size_t depth) {
+    max_depth = depth;
+}
+
+void InterpreterVisitor::push_call_stack() {
+    if (call_stack.size() >= max_depth) throw call_depth_error(max_depth);
+    call_stack.emplace_back(args.size(), scopes.size(), values.size());
+}
+
+void InterpreterVisitor::pop_call_stack() {
+    const CallStackFrame& frame = call_stack.back();
+    args.resize(frame.args);
+    scopes.resize(frame.scopes);
+    values.truncate(frame.values);
+    call_stack.pop_back();
+}
+
+void InterpreterVisitor::push_scope() { scopes.push_back(values.size()); }
 
-void InterpreterVisitor::pop_call_stack() { return call_stack.pop_back(); }
+void InterpreterVisitor::pop_scope() {
+    // variables passed on to a pending tail call are released along with the frame
+    if (!tail_call) values.truncate(scopes.back());
+    scopes.pop_back();
+}
+
+void InterpreterVisitor::bind_args(const Function& func, ArgVector& func_args) {
+    call_stack.back().function = &func;
+
+    // references are bound directly, values become variables of the new frame
+    const auto params = func.get_signature()->get_params();
+    for (size_t i = 0; i < params.size(); ++i) {
+        const VariableSignature* param = params[i];
+        Variable* ref = std::visit(
+            Overload{[](Variable* var) { return var; },
+                     [this, param](ValType& value) {
+                         return values.push(Variable{param, std::move(value)});
+                     }},
+            func_args[i]);
+        args.push_back({ref, param->get_symbol()});
+    }
+}
 
-auto InterpreterVisitor::find_var_in_frame(const std::string& name) -> std::weak_ptr<Variable> {
-    CallStackFrame& frame = call_stack.back();
+void InterpreterVisitor::run_function(const Function& func, ArgVector& func_args) {
+    push_call_stack();
+    // release the frame even if the function throws
+    struct FrameGuard {
+        InterpreterVisitor& interpreter;
+        ~FrameGuard() { interpreter.pop_call_stack(); }
+    } guard{*this};
+
+    bind_args(func, func_args);
+    func.accept(*this);
+
+    // tail calls reuse the frame, one after another, until a body returns a value
+    std::optional<TailCall> last;
+    while (tail_call) {
+        last = std::move(tail_call);
+        tail_call.reset();
+
+        const CallStackFrame& frame = call_stack.back();
+        args.resize(frame.args);
+        scopes.resize(frame.scopes);
+        values.truncate_keeping(frame.values, last->args);
+
+        const Function& target = *last->target->get_func();
+        bind_args(target, last->args);
+        target.accept(*this);
+    }
 
-    // find in local vars
-    for (auto& block : std::ranges::reverse_view(frame.var_scope)) {
-        auto var_it =
-            std::ranges::find_if(block.vars, [&name](const std::shared_ptr<Variable>& var) {
-                return var->signature.get_name() == name;
-            });
-        if (var_it != block.vars.end()) {
-            return *var_it;
+    // all functions of the chain return the same type, only the innermost cast can fail
+    if (last) {
+        try {
+            last->target->finish_call(*this);
+        } catch (InterpreterError& e) {
+            throw GeneralError(last->position, e.what());
         }
     }
+}
+
+auto InterpreterVisitor::defer_tail_call(const std::shared_ptr<Callable>& callee,
+                                         ArgVector& call_args, Position position) -> bool {
+    GlobalFunction* target = callee->get_target(call_args);
+    if (!target) return false;
+    if (!target->can_replace(call_stack.back().function->get_signature()->get_type())) {
+        // the callee binds its arguments again when called as usual
+        call_args.erase(call_args.begin(),
+                        call_args.begin() + static_cast<ptrdiff_t>(callee->bound_count()));
+        return false;
+    }
 
-    // find in function args (references)
-    auto ref_var = std::ranges::find_if(
-        frame.args, [&name](const auto& arg) { return arg->curr_name == name; });
+    // arguments are checked while the variables they refer to are still in scope
+    target->prepare_call(*this, call_args);
+    tail_call = TailCall{callee, target, std::move(call_args), position};
+    return true;
+}
 
-    if (ref_var < frame.args.end()) return ref_var->get()->ref;
+void InterpreterVisitor::resolve(const Function& func) {
+    Resolver resolver(&functions);
+    func.accept(resolver);
+}
 
-    return {};
+auto InterpreterVisitor::find_var_in_frame(const std::string& name) -> Variable* {
+    // a name that was never interned cannot name a variable
+    auto symbol = Symbol::find(name);
+    if (!symbol) return nullptr;
+    return find_var_in_frame(*symbol);
 }
 
-auto InterpreterVisitor::find_func(const std::string& name) -> std::shared_ptr<Callable> {
-    auto func = std::ranges::find_if(
-        functions, [&name](const auto& func) { return func->get_name() == name; });
+auto InterpreterVisitor::find_var_in_frame(Symbol name) -> Variable* {
+    const CallStackFrame& frame = call_stack.back();
+
+    // find in local vars, variables cannot be re-defined within a frame so any order will do
+    if (scopes.size() > frame.scopes) {
+        for (size_t i = values.size(); i-- > scopes[frame.scopes];) {
+            if (values[i].signature->get_symbol() == name) return &values[i];
+        }
+    }
+
+    // find in function args (references)
+    for (size_t i = frame.args; i < args.size(); ++i) {
+        if (args[i].curr_name == name) return args[i].ref;
+    }
 
-    if (func < functions.end()) return *func;
     return nullptr;
 }
 
-void InterpreterVisitor::modify_var(const std::string& identifier) {
+auto InterpreterVisitor::find_func(const std::string& name) -> std::shared_ptr<Callable> {
+    return functions.load(Symbol(name));
+}
+
+auto InterpreterVisitor::find_func(Symbol name) -> std::shared_ptr<Callable> {
+    return functions.load(name);
+}
+
+auto InterpreterVisitor::get_var(VarSlot slot) -> Variable* {
+    const CallStackFrame& frame = call_stack.back();
+    if (slot.depth == 0) return args[frame.args + slot.slot].ref;
+    return &values[scopes[frame.scopes + slot.depth - 1] + slot.slot];
+}
+
+void InterpreterVisitor::modify_var(Symbol identifier, std::optional<VarSlot> slot) {
     ValType value = current_value;
-    std::shared_ptr<Variable> var = find_var_in_frame(identifier).lock();
+    Variable* var = slot ? get_var(*slot) : find_var_in_frame(identifier);
 
-    shall(var != nullptr, "Variable not in scope: " + identifier);
+    shall(var != nullptr, [identifier] { return "Variable not in scope: " + identifier.str(); });
 
-    const Type* type = var->signature.get_type();
+    const Type* type = var->get_type();
     shall(type->get_mut(), "Immutable variables cannot be reassigned");
 
     var->value = std::visit(TypeCast(), value, var->value);
 }
 
-template <typename... Ts>
-struct Overload : Ts... {
-    using Ts::operator()...;
-};
-template <class... Ts>
-Overload(Ts...) -> Overload<Ts...>;
 auto InterpreterVisitor::init_var(const Type& type) -> ValType {
     type.accept(*this);
-    return std::visit(Overload{[](const Type* type) -> ValType {
-                                   return std::make_shared<LocalFunction>(type->clone());
-                               },
-                               [](BaseType type) -> ValType {
-                                   switch (type) {
-                                       case BaseType::INT:
-                                           return 0;
-                                       case BaseType::FLT:
-                                           return 0.0;
-                                       case BaseType::BOOL:
-                                           return true;
-                                       case BaseType::STRING:
-                                           return "";
-                                       case BaseType::VOID:
-                                           return std::monostate();
-                                   }
-                                   throw InterpreterError("Unable to initialize variable");
-                               }},
-                      current_type);
+    return default_value(type);
+}
+
+auto default_value(const Type& type) -> ValType {
+    if (type.is_func()) return std::make_shared<LocalFunction>(type.clone());
+    switch (static_cast<const VarType&>(type).get_type()) {
+        case BaseType::INT:
+            return 0;
+        case BaseType::FLT:
+            return 0.0;
+        case BaseType::BOOL:
+            return true;
+        case BaseType::STRING:
+            return "";
+        case BaseType::VOID:
+            return std::monostate();
+    }
+    throw InterpreterError("Unable to initialize variable");
+}
+
+auto cast_value(const ValType& value, const Type& type) -> ValType {
+    if (!type.is_func()) return std::visit(TypeCast(), value, default_value(type));
+
+    const auto* func = std::get_if<std::shared_ptr<Callable>>(&value);
+    if (!func) throw InterpreterError("Cannot cast type");
+    if (!(*func)->get_type()->is_equal_to(&type)) {
+        throw InterpreterError("Functions have a different number of parameters");
+    }
+    return value;
+}
+
+auto literal_value(const ValueType& value) -> ValType {
+    return std::visit([](const auto& v) -> ValType { return ValType{v}; }, value);
+}
+
+auto call_depth_error(size_t max_depth) -> InterpreterError {
+    return InterpreterError("Stack overflow, exceeded the maximum depth of " +
+                            std::to_string(max_depth) + " nested calls");
 }
 
 void InterpreterVisitor::register_var(const VariableSignature& signature) {
-    ValType value = current_value;
-    ValType var_val = init_var(*signature.get_type());
-    var_val = std::visit(TypeCast(), value, var_val);
-    call_stack.back().var_scope.back().vars.push_back(
-        std::make_shared<Variable>(signature, var_val));
+    values.push(Variable{&signature, cast_value(current_value, *signature.get_type())});
 }
 
 auto InterpreterVisitor::eval_condition(const Expression& expr) -> bool {
@@ -105,15 +219,13 @@ auto InterpreterVisitor::eval_condition(const Expression& expr) -> bool {
     return std::get<bool>(std::visit(TypeCast(), current_value, ValType{true}));
 }
 
-auto InterpreterVisitor::get_for_iterator(const ForLoopArgs& args) -> std::weak_ptr<Variable> {
+auto InterpreterVisitor::get_for_iterator(const ForLoopArgs& args) -> Variable* {
     return std::visit(Overload{[this](const std::unique_ptr<Statement>& iterator) {
                                    iterator->accept(*this);
-                                   return this->call_stack.back().var_scope.back().vars.back();
+                                   return &values.back();
                                },
-                               [this](const std::string& iterator) {
-                                   auto var = find_var_in_frame(iterator);
-                                   shall(var.lock(), "Invalid iterator");
-                                   return var.lock();
+                               [this](Symbol iterator) {
+                                   return shall(find_var_in_frame(iterator), "Invalid iterator");
                                }},
                       args.iterator);
 }
@@ -1,71 +1,82 @@
 #include "arithmetics.h"
-#include "interpreter.h"
+#include "engine.h"
 #include "interpreter_shall.h"
 #include "local_function.h"
+#include "overload.h"
 #include "type_cast.h"
 
 GlobalFunction::GlobalFunction(const Function* func) : func(func) {
     type = func->get_signature()->clone_type_as_type_obj();
 }
 
-auto GlobalFunction::prepare_func_args(InterpreterVisitor& interpreter, ArgVector& args) const
-    -> std::vector<std::shared_ptr<VarRef>> {
+void GlobalFunction::prepare_func_args(ArgVector& args) const {
     const auto expected = func->get_signature()->get_params();
     shall(expected.size() == args.size(), "Invalid argument vector size");
-    std::vector<std::shared_ptr<VarRef>> var_refs;
     for (size_t i = 0; i < expected.size(); ++i) {
         auto expected_arg = expected[i];
         std::visit(
             Overload{
-                [&](std::shared_ptr<Variable> var) {
+                [&](Variable* var) {
                     shall(expected_arg->get_type()->is_equal_to(var->get_type()), "Type mismatch");
-                    var_refs.push_back(std::make_shared<VarRef>(var, expected[i]->get_name()));
                 },
-                [&](ValType value) {
-                    auto type = expected[i]->get_type();
-                    value = std::visit(TypeCast(), value, interpreter.init_var(*type));
-                    auto temp_var = std::make_shared<Variable>(*expected[i], value);
-                    var_refs.push_back(std::make_shared<VarRef>(temp_var, expected[i]->get_name()));
-                }},
+                [&](ValType& value) { value = cast_value(value, *expected_arg->get_type()); }},
             args[i]);
     }
-    return var_refs;
 }
 
-/**
- * @brief verify argument types, push call frame and call
- */
-void GlobalFunction::call(InterpreterVisitor& interpreter, ArgVector args) {
-    // turn non-referenced args into temporary variables, and verify type integrity
-    auto prepared_args = prepare_func_args(interpreter, args);
-
-    CallStackFrame frame = CallStackFrame(prepared_args, std::vector<BlockScope>());
+void GlobalFunction::prepare_call(Engine& engine, ArgVector& args) const {
+    // a skipped body is parsed on the first call
+    if (func->parse_body()) engine.resolve(*func);
 
-    // push new call stack frame
-    interpreter.push_call_stack(frame);
-
-    // proper call
-    func->accept(interpreter);
+    // cast non-referenced args to the parameter types, and verify type integrity
+    prepare_func_args(args);
+}
 
+void GlobalFunction::finish_call(Engine& engine) const {
     // verify the received type
-    auto current_val = interpreter.get_value();
+    static const VarType void_type(BaseType::VOID, false);
     auto ret_type = get_type()->get_ret_type();
-    if (!ret_type->is_equal_to(std::make_unique<VarType>(BaseType::VOID, false).get())) {
-        auto retval = interpreter.init_var(*ret_type);
+    if (!ret_type->is_equal_to(&void_type)) {
         // cast the value into desired return type
-        interpreter.override_value(std::visit(TypeCast(), current_val, retval));
+        engine.override_value(cast_value(engine.get_value(), *ret_type));
     }
+}
+
+/**
+ * @brief verify argument types, let the engine run the function and cast its result
+ */
+void GlobalFunction::call(Engine& engine, ArgVector& args) {
+    prepare_call(engine, args);
+
+    // proper call
+    engine.run_function(*func, args);
 
-    // dispose of the call stack frame
-    interpreter.pop_call_stack();
+    finish_call(engine);
 }
 
 auto GlobalFunction::get_func() const -> const Function* { return func; }
 
+auto Callable::bound_type(size_t skip) -> std::shared_ptr<const Type> {
+    if (skip < bound_types.size() && bound_types[skip]) return bound_types[skip];
+
+    std::shared_ptr<const Type> type = get_type()->clone(skip);
+    if (skip >= bound_types.size()) bound_types.resize(skip + 1);
+    bound_types[skip] = type;
+    return type;
+}
+
 LocalFunction::LocalFunction(std::shared_ptr<Callable> callee_func, ArgVector bound_args)
-    : callee(std::move(callee_func)), bound_args(bound_args) {
+    : callee(std::move(callee_func)), bound_args(std::move(bound_args)) {
+    // the arguments of an inner bind front come first, bind them along with ours
+    if (auto inner = std::dynamic_pointer_cast<LocalFunction>(callee); inner && inner->callee) {
+        this->bound_args.insert(this->bound_args.begin(), inner->bound_args.begin(),
+                                inner->bound_args.end());
+        callee = inner->callee;
+    }
+
     // adjust this function's type
-    type = callee->get_type()->clone(bound_args.size());
+    type = callee->bound_type(this->bound_args.size());
+    bound = this->bound_args.size() + callee->bound_count();
 }
 
 LocalFunction::LocalFunction(std::unique_ptr<Type> type) : type(std::move(type)) {}
@@ -73,15 +84,21 @@ LocalFunction::LocalFunction(std::unique_ptr<Type> type) : type(std::move(type))
 /**
  * @brief bind arguments and call
  */
-void LocalFunction::call(InterpreterVisitor& interpreter, ArgVector args) {
+void LocalFunction::call(Engine& engine, ArgVector& args) {
     shall(callee, "No function to call");
 
-    ArgVector full_arg_list = bound_args;
-    full_arg_list.insert(full_arg_list.end(), args.begin(), args.end());
+    args.insert(args.begin(), bound_args.begin(), bound_args.end());
+    callee->call(engine, args);
+}
 
-    callee->call(interpreter, full_arg_list);
+auto LocalFunction::get_target(ArgVector& args) -> GlobalFunction* {
+    if (!callee) return nullptr;
 
-    return;
+    // outer layers bind their arguments first, in front of the inner ones
+    args.insert(args.begin(), bound_args.begin(), bound_args.end());
+    GlobalFunction* target = callee->get_target(args);
+    if (!target) args.erase(args.begin(), args.begin() + static_cast<ptrdiff_t>(bound_args.size()));
+    return target;
 }
 
 auto LocalFunction::get_func() const -> const Function* {
@@ -0,0 +1,590 @@
+#include "program_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "visitor.h"
+
+#ifndef TKOM_VERSION
+#define TKOM_VERSION "unknown"
+#endif
+
+namespace {
+
+constexpr std::string_view magic = "TKOMC\n";
+
+/**
+ * @brief small enum representing the kind of a serialized node, NONE marks a missing node
+ */
+enum class Tag : uint8_t {
+    NONE = 0,
+    LITERAL,
+    IDENTIFIER,
+    UNARY,
+    BINARY,
+    CALL,
+    BINDFRT,
+    FOR,
+    WHILE,
+    CONDITIONAL,
+    ELSE,
+    RET,
+    CALL_STMT,
+    ASSIGN,
+    VAR_TYPE,
+    FUNC_TYPE,
+};
+
+/**
+ * @brief 64-bit FNV-1a hash of a block of memory
+ */
+auto hash_bytes(std::string_view bytes) -> uint64_t {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char ch : bytes) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief thrown when an image ends early or contains invalid data
+ */
+struct CorruptCache : std::runtime_error {
+    CorruptCache() : std::runtime_error("corrupt program cache") {}
+};
+
+/**
+ * @brief the fields a cache image has to match to be used
+ */
+struct CacheKey {
+    bool folded;
+    uint64_t source_size;
+    uint64_t source_hash;
+};
+
+auto key_of(const SourceBuffer &source, bool folded) -> CacheKey {
+    return {folded, source.size(), hash_bytes({source.data(), source.size()})};
+}
+
+/**
+ * @brief visitor serializing a program
+ *
+ * Every name is written once into the symbol table preceding the program, nodes refer to it by
+ * index, so loading the image interns each name only once.
+ */
+class CacheWriter : public Visitor {
+   private:
+    std::string out;  //< the serialized program
+    std::vector<Symbol> symbols;  //< the symbol table, in order of first use
+    std::unordered_map<Symbol, uint32_t> symbol_ids;  //< index of each symbol in the table
+
+    template <typename T>
+    static void put(std::string &buffer, T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+    template <typename T>
+    void put(T value) {
+        put(out, value);
+    }
+    static void put_text(std::string &buffer, std::string_view text) {
+        put<uint32_t>(buffer, text.size());
+        buffer.append(text);
+    }
+    void put_tag(Tag tag) { put(tag); }
+    void put_position(Position pos) {
+        put(pos.get_line());
+        put(pos.get_column());
+    }
+    void put_symbol(Symbol symbol) {
+        auto [it, inserted] = symbol_ids.try_emplace(symbol, symbols.size());
+        if (inserted) symbols.push_back(symbol);
+        put(it->second);
+    }
+    void put_value(const ValueType &value) {
+        put<uint8_t>(value.index());
+        std::visit(
+            [this](const auto &held) {
+                using T = std::decay_t<decltype(held)>;
+                if constexpr (std::is_same_v<T, std::string>) {
+                    put_text(out, held);
+                } else if constexpr (!std::is_same_v<T, std::monostate>) {
+                    put(held);
+                }
+            },
+            value);
+    }
+    void put_folded(const std::optional<ValueType> &folded) {
+        put<uint8_t>(folded.has_value());
+        if (folded) put_value(*folded);
+    }
+    template <typename N>
+    void put_node(const N *node) {
+        if (node) {
+            node->accept(*this);
+        } else {
+            put_tag(Tag::NONE);
+        }
+    }
+    template <typename N>
+    void put_nodes(NodeView<N> nodes) {
+        put<uint32_t>(nodes.size());
+        for (const auto *node : nodes) node->accept(*this);
+    }
+
+   public:
+    /**
+     * @brief get the image of the visited program
+     */
+    [[nodiscard]] auto finish(const CacheKey &key) const -> std::string {
+        std::string image(magic);
+        put(image, ProgramCache::format_version);
+        put_text(image, TKOM_VERSION);
+        put<uint8_t>(image, key.folded);
+        put(image, key.source_size);
+        put(image, key.source_hash);
+        put<uint32_t>(image, symbols.size());
+        for (const auto &symbol : symbols) put_text(image, symbol.str());
+        return image + out;
+    }
+
+    void visit(const Program &program) override { put_nodes(program.get_functions()); }
+
+    void visit(const LiteralExpr &expr) override {
+        put_tag(Tag::LITERAL);
+        put_position(expr.get_position());
+        put(expr.get_type());
+        put_value(expr.get_value());
+    }
+    void visit(const IdentifierExpr &expr) override {
+        put_tag(Tag::IDENTIFIER);
+        put_position(expr.get_position());
+        put_symbol(expr.get_symbol());
+    }
+    void visit(const UnaryExpr &expr) override {
+        put_tag(Tag::UNARY);
+        put_position(expr.get_position());
+        put(expr.get_operator());
+        put_node(expr.get_right());
+        put_folded(expr.get_folded());
+    }
+    void visit(const BinaryExpr &expr) override {
+        put_tag(Tag::BINARY);
+        put_position(expr.get_position());
+        put_node(expr.get_left());
+        put(expr.get_operator());
+        put_node(expr.get_right());
+        put_folded(expr.get_folded());
+    }
+    void visit(const CallExpr &expr) override {
+        put_tag(Tag::CALL);
+        put_position(expr.get_position());
+        put_node(expr.get_func_name());
+        put_nodes(expr.get_args());
+    }
+    void visit(const BindFrtExpr &expr) override {
+        put_tag(Tag::BINDFRT);
+        put_position(expr.get_position());
+        put_node(expr.get_func_name());
+        put_nodes(expr.get_args());
+    }
+
+    void visit(const ForLoopStatement &stmt) override {
+        put_tag(Tag::FOR);
+        put_position(stmt.get_position());
+        const auto &iterator = stmt.get_args()->iterator;
+        put<uint8_t>(iterator.index());
+        if (const auto *symbol = std::get_if<Symbol>(&iterator)) {
+            put_symbol(*symbol);
+        } else {
+            put_node(std::get<std::unique_ptr<Statement>>(iterator).get());
+        }
+        put_node(stmt.get_args()->condition.get());
+        stmt.get_body()->accept(*this);
+        put_node(stmt.get_on_iter());
+    }
+    void visit(const WhileLoopStatement &stmt) override {
+        put_tag(Tag::WHILE);
+        put_position(stmt.get_position());
+        put_node(stmt.get_condition());
+        stmt.get_body()->accept(*this);
+    }
+    void visit(const ConditionalStatement &stmt) override {
+        put_tag(Tag::CONDITIONAL);
+        put_position(stmt.get_position());
+        put(stmt.get_type());
+        put_node(stmt.get_condition());
+        stmt.get_body()->accept(*this);
+        put_node(stmt.get_else_st());
+    }
+    void visit(const ElseStatement &stmt) override {
+        put_tag(Tag::ELSE);
+        put_position(stmt.get_position());
+        stmt.get_body()->accept(*this);
+    }
+    void visit(const RetStatement &stmt) override {
+        put_tag(Tag::RET);
+        put_position(stmt.get_position());
+        put_node(stmt.get_retval());
+    }
+    void visit(const CallStatement &stmt) override {
+        put_tag(Tag::CALL_STMT);
+        put_position(stmt.get_position());
+        put_node(stmt.get_call());
+    }
+    void visit(const AssignStatement &stmt) override {
+        put_tag(Tag::ASSIGN);
+        put_position(stmt.get_position());
+        put_node(stmt.get_value());
+        stmt.get_signature()->accept(*this);
+    }
+
+    void visit(const Block &block) override { put_nodes(block.get_statements()); }
+    void visit(const VarType &type) override {
+        put_tag(Tag::VAR_TYPE);
+        put(type.get_type());
+        put<uint8_t>(type.get_mut());
+    }
+    void visit(const FuncType &type) override {
+        put_tag(Tag::FUNC_TYPE);
+        put_node(type.get_ret_type());
+        put_nodes(type.get_params());
+    }
+
+    void visit(const VariableSignature &var) override {
+        put_node(var.get_type());
+        put_symbol(var.get_symbol());
+        put_position(var.get_position());
+    }
+    void visit(const FuncSignature &sign) override {
+        put_position(sign.get_position());
+        put_node(sign.get_type());
+        put_nodes(sign.get_params());
+        put_symbol(sign.get_symbol());
+    }
+    void visit(const Function &func) override {
+        func.get_signature()->accept(*this);
+        func.get_body()->accept(*this);
+    }
+};
+
+/**
+ * @brief rebuilds a program from its image, in the mirrored order of `CacheWriter`
+ */
+class CacheReader {
+   private:
+    const char *at;  //< the next byte to read
+    const char *end;  //< the end of the image
+    std::vector<Symbol> symbols;  //< the image's symbol table
+
+    template <typename T>
+    auto get() -> T {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (static_cast<size_t>(end - at) < sizeof(T)) throw CorruptCache();
+        T value;
+        std::memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+    /**
+     * @brief read an enum, checking it against its last enumerator
+     */
+    template <typename E>
+    auto get_enum(E last) -> E {
+        const E value = get<E>();
+        if (static_cast<uint32_t>(value) > static_cast<uint32_t>(last)) throw CorruptCache();
+        return value;
+    }
+    auto get_text() -> std::string_view {
+        const auto size = get<uint32_t>();
+        if (static_cast<size_t>(end - at) < size) throw CorruptCache();
+        std::string_view text(at, size);
+        at += size;
+        return text;
+    }
+    auto get_tag() -> Tag { return get_enum(Tag::FUNC_TYPE); }
+    auto get_count() -> uint32_t {
+        // every node takes at least a byte, which rejects absurd counts before allocating
+        const auto count = get<uint32_t>();
+        if (count > static_cast<size_t>(end - at)) throw CorruptCache();
+        return count;
+    }
+    auto get_position() -> Position {
+        const auto line = get<uint32_t>();
+        return {line, get<uint32_t>()};
+    }
+    auto get_symbol() -> Symbol {
+        const auto id = get<uint32_t>();
+        if (id >= symbols.size()) throw CorruptCache();
+        return symbols[id];
+    }
+    auto get_value() -> ValueType {
+        switch (get<uint8_t>()) {
+            case 0:
+                return std::monostate();
+            case 1:
+                return std::string(get_text());
+            case 2:
+                return get<int>();
+            case 3:
+                return get<double>();
+            case 4:
+                return get<uint8_t>() != 0;
+            default:
+                throw CorruptCache();
+        }
+    }
+    auto get_folded() -> std::optional<ValueType> {
+        if (!get<uint8_t>()) return std::nullopt;
+        return get_value();
+    }
+    auto get_exprs() -> std::vector<ExprPtr> {
+        std::vector<ExprPtr> exprs(get_count());
+        for (auto &expr : exprs) {
+            expr = get_expr();
+            if (!expr) throw CorruptCache();
+        }
+        return exprs;
+    }
+
+    auto get_expr() -> ExprPtr {
+        const Tag tag = get_tag();
+        if (tag == Tag::NONE) return nullptr;
+        const Position pos = get_position();
+        switch (tag) {
+            case Tag::LITERAL: {
+                const BaseType type = get_enum(BaseType::VOID);
+                return std::make_unique<LiteralExpr>(pos, type, get_value());
+            }
+            case Tag::IDENTIFIER:
+                return std::make_unique<IdentifierExpr>(pos, get_symbol());
+            case Tag::UNARY: {
+                const UnaryOp op = get_enum(UnaryOp::MINUS);
+                auto expr = std::make_unique<UnaryExpr>(pos, op, get_expr());
+                expr->set_folded(get_folded());
+                return expr;
+            }
+            case Tag::BINARY: {
+                auto left = get_expr();
+                const BinaryOp op = get_enum(BinaryOp::DECORATE);
+                auto expr = std::make_unique<BinaryExpr>(pos, std::move(left), op, get_expr());
+                expr->set_folded(get_folded());
+                return expr;
+            }
+            case Tag::CALL: {
+                auto name = get_expr();
+                return std::make_unique<CallExpr>(pos, std::move(name), get_exprs());
+            }
+            case Tag::BINDFRT: {
+                auto name = get_expr();
+                return std::make_unique<BindFrtExpr>(pos, std::move(name), get_exprs());
+            }
+            default:
+                throw CorruptCache();
+        }
+    }
+
+    auto get_statement() -> std::unique_ptr<Statement> {
+        const Tag tag = get_tag();
+        if (tag == Tag::NONE) return nullptr;
+        const Position pos = get_position();
+        switch (tag) {
+            case Tag::FOR: {
+                auto args = std::make_unique<ForLoopArgs>();
+                if (get<uint8_t>()) {
+                    args->iterator = get_symbol();
+                } else {
+                    args->iterator = get_statement();
+                }
+                args->condition = get_expr();
+                auto body = get_block();
+                auto on_iter = get_expr();
+                return std::make_unique<ForLoopStatement>(pos, std::move(args), std::move(body),
+                                                          std::move(on_iter));
+            }
+            case Tag::WHILE: {
+                auto condition = get_expr();
+                return std::make_unique<WhileLoopStatement>(pos, std::move(condition),
+                                                            get_block());
+            }
+            case Tag::CONDITIONAL: {
+                // conditionals are only ever parsed from an `if` or an `elif`
+                const auto type = get<TokenType>();
+                if (type != TokenType::T_IF && type != TokenType::T_ELIF) throw CorruptCache();
+                auto condition = get_expr();
+                auto body = get_block();
+                return std::make_unique<ConditionalStatement>(pos, type, std::move(condition),
+                                                              std::move(body), get_statement());
+            }
+            case Tag::ELSE:
+                return std::make_unique<ElseStatement>(pos, get_block());
+            case Tag::RET:
+                return std::make_unique<RetStatement>(pos, get_expr());
+            case Tag::CALL_STMT:
+                return std::make_unique<CallStatement>(pos, get_expr());
+            case Tag::ASSIGN: {
+                auto value = get_expr();
+                return std::make_unique<AssignStatement>(pos, std::move(value), get_variable());
+            }
+            default:
+                throw CorruptCache();
+        }
+    }
+
+    auto get_block() -> std::unique_ptr<Block> {
+        std::vector<std::unique_ptr<Statement>> statements(get_count());
+        for (auto &stmt : statements) {
+            stmt = get_statement();
+            if (!stmt) throw CorruptCache();
+        }
+        return std::make_unique<Block>(std::move(statements));
+    }
+
+    auto get_type() -> std::unique_ptr<Type> {
+        switch (get_tag()) {
+            case Tag::NONE:
+                return nullptr;
+            case Tag::VAR_TYPE: {
+                const BaseType type = get_enum(BaseType::VOID);
+                return std::make_unique<VarType>(type, get<uint8_t>() != 0);
+            }
+            case Tag::FUNC_TYPE: {
+                auto ret_type = get_type();
+                std::vector<std::unique_ptr<Type>> params(get_count());
+                for (auto &param : params) {
+                    param = get_type();
+                    if (!param) throw CorruptCache();
+                }
+                return std::make_unique<FuncType>(std::move(ret_type), std::move(params));
+            }
+            default:
+                throw CorruptCache();
+        }
+    }
+
+    auto get_variable() -> std::unique_ptr<VariableSignature> {
+        auto type = get_type();
+        const Symbol name = get_symbol();
+        return std::make_unique<VariableSignature>(std::move(type), name, get_position());
+    }
+
+    auto get_function() -> std::unique_ptr<Function> {
+        const Position pos = get_position();
+        auto ret_type = get_type();
+        std::vector<std::unique_ptr<VariableSignature>> params(get_count());
+        for (auto &param : params) param = get_variable();
+        auto signature = std::make_unique<FuncSignature>(pos, std::move(ret_type),
+                                                         std::move(params), get_symbol());
+        return std::make_unique<Function>(std::move(signature), get_block());
+    }
+
+   public:
+    CacheReader(const char *data, size_t size) : at(data), end(data + size) {}
+
+    /**
+     * @brief read the image header and the symbol table
+     *
+     * @return false if the image was made for another source or by another interpreter
+     */
+    auto read_header(const CacheKey &key) -> bool {
+        if (static_cast<size_t>(end - at) < magic.size() ||
+            std::string_view(at, magic.size()) != magic) {
+            return false;
+        }
+        at += magic.size();
+        if (get<uint32_t>() != ProgramCache::format_version) return false;
+        if (get_text() != TKOM_VERSION) return false;
+        if (get<uint8_t>() != key.folded) return false;
+        if (get<uint64_t>() != key.source_size) return false;
+        if (get<uint64_t>() != key.source_hash) return false;
+
+        const auto count = get_count();
+        symbols.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) symbols.emplace_back(get_text());
+        return true;
+    }
+
+    /**
+     * @brief read the program, placing its nodes in a fresh arena
+     */
+    auto read_program() -> std::unique_ptr<Program> {
+        auto arena = std::make_unique<Arena>();
+        std::vector<std::unique_ptr<Function>> functions;
+        {
+            Arena::Scope scope(*arena);
+            functions.resize(get_count());
+            for (auto &func : functions) func = get_function();
+        }
+        if (at != end) throw CorruptCache();
+        return std::make_unique<Program>(std::move(functions), std::move(arena));
+    }
+};
+
+}  // namespace
+
+auto ProgramCache::path_for(const std::string &source_file, const std::string &cache_dir)
+    -> std::string {
+    namespace fs = std::filesystem;
+    if (cache_dir.empty()) return fs::path(source_file).replace_extension(".tkomc").string();
+
+    const std::string absolute = fs::absolute(source_file).lexically_normal().string();
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx",
+                  static_cast<unsigned long long>(hash_bytes(absolute)));
+    const std::string name = fs::path(source_file).stem().string() + "." + hash + ".tkomc";
+    return (fs::path(cache_dir) / name).string();
+}
+
+auto ProgramCache::load(const SourceBuffer &source) const -> std::unique_ptr<Program> {
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error)) return nullptr;
+
+    const auto image = SourceBuffer::from_file(path);
+    CacheReader reader(image->data(), image->size());
+    try {
+        if (!reader.read_header(key_of(source, folded))) return nullptr;
+        return reader.read_program();
+    } catch (const CorruptCache &) {
+        return nullptr;
+    }
+}
+
+auto ProgramCache::store(const Program &program, const SourceBuffer &source) const -> bool {
+    for (const auto *func : program.get_functions()) {
+        if (!func->get_body()) return false;
+    }
+
+    CacheWriter writer;
+    program.accept(writer);
+    const std::string image = writer.finish(key_of(source, folded));
+
+    namespace fs = std::filesystem;
+    std::error_code error;
+    const fs::path target(path);
+    if (target.has_parent_path()) fs::create_directories(target.parent_path(), error);
+
+    const std::string temporary = path + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        output.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!output) {
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
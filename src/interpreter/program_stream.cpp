@@ -0,0 +1,20 @@
+#include "program_stream.h"
+
+ProgramStream::ProgramStream(std::shared_ptr<Parser> parser,
+                             std::function<void(const Function&)> on_parsed)
+    : parser(std::move(parser)),
+      program(std::make_unique<Program>(std::vector<std::unique_ptr<Function>>(),
+                                        std::make_unique<Arena>())),
+      on_parsed(std::move(on_parsed)) {}
+
+auto ProgramStream::next() -> const Function* {
+    if (finished) return nullptr;
+
+    const Function* func = parser->parse_function(*program);
+    if (!func) {
+        finished = true;
+        return nullptr;
+    }
+    if (on_parsed) on_parsed(*func);
+    return func;
+}
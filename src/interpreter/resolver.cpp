@@ -0,0 +1,212 @@
+#include "resolver.h"
+
+#include <algorithm>
+
+#include "local_function.h"
+#include "overload.h"
+
+/**
+ * @brief get the base type of a variable type, empty for function and void types
+ */
+static auto declared_type(const Type* type) -> std::optional<BaseType> {
+    const auto* var_type = dynamic_cast<const VarType*>(type);
+    if (!var_type || var_type->get_type() == BaseType::VOID) return std::nullopt;
+    return var_type->get_type();
+}
+
+static auto is_numeric(std::optional<BaseType> type) -> bool {
+    return type == BaseType::INT || type == BaseType::FLT || type == BaseType::BOOL;
+}
+
+/**
+ * @brief static type of a binary operation, following the weak-typing rules of `arithmetics.h`
+ */
+static auto binary_result_type(BinaryOp op, std::optional<BaseType> left,
+                               std::optional<BaseType> right) -> std::optional<BaseType> {
+    const bool numeric = is_numeric(left) && is_numeric(right);
+    // arithmetic promotes booleans to integers and integers to floats
+    const auto promoted =
+        left == BaseType::FLT || right == BaseType::FLT ? BaseType::FLT : BaseType::INT;
+
+    switch (op) {
+        case BinaryOp::ADD:
+            // anything but a function can be appended to a string
+            if (left == BaseType::STRING || right == BaseType::STRING) return BaseType::STRING;
+            [[fallthrough]];
+        case BinaryOp::SUB:
+        case BinaryOp::DIV:
+            if (numeric) return promoted;
+            return std::nullopt;
+        case BinaryOp::MULT:
+            if (numeric) return promoted;
+            if ((left == BaseType::STRING && right == BaseType::INT) ||
+                (left == BaseType::INT && right == BaseType::STRING)) {
+                return BaseType::STRING;
+            }
+            return std::nullopt;
+        case BinaryOp::LT:
+        case BinaryOp::GT:
+        case BinaryOp::LTE:
+        case BinaryOp::GTE:
+        case BinaryOp::EQ:
+        case BinaryOp::NEQ:
+        case BinaryOp::AND:
+        case BinaryOp::OR:
+            if (numeric || (left == BaseType::STRING && right == BaseType::STRING)) {
+                return BaseType::BOOL;
+            }
+            return std::nullopt;
+        case BinaryOp::DECORATE:
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+auto Resolver::find(Symbol name) const -> std::optional<VarSlot> {
+    // block scopes first, innermost to outermost, then parameters
+    for (size_t depth = scopes.size(); depth-- > 0;) {
+        const auto& scope = scopes[depth];
+        auto var = std::ranges::find(scope, name, &Local::name);
+        if (var != scope.end()) {
+            return VarSlot{static_cast<uint32_t>(depth), static_cast<uint32_t>(var - scope.begin())};
+        }
+    }
+    return std::nullopt;
+}
+
+auto Resolver::infer(const Expression* expr) -> std::optional<BaseType> {
+    current_type = std::nullopt;
+    expr->accept(*this);
+    return current_type;
+}
+
+void Resolver::visit(const Program& program) {
+    for (const auto* func : program.get_functions()) func->accept(*this);
+}
+
+void Resolver::visit(const Function& func) {
+    // skipped bodies are resolved once they are parsed
+    if (!func.get_body()) return;
+
+    scopes.clear();
+    auto& params = scopes.emplace_back();
+    for (const auto* param : func.get_signature()->get_params()) {
+        params.push_back({param->get_symbol(), declared_type(param->get_type())});
+    }
+    func.get_body()->accept(*this);
+    scopes.clear();
+}
+
+void Resolver::visit(const Block& block) {
+    scopes.emplace_back();
+    for (const auto* stmt : block.get_statements()) stmt->accept(*this);
+    scopes.pop_back();
+}
+
+Resolver::Resolver(const FunctionTable* globals) : globals(globals) {}
+
+void Resolver::visit(const LiteralExpr& expr) {
+    current_type = std::visit(
+        Overload{[](int) -> std::optional<BaseType> { return BaseType::INT; },
+                 [](double) -> std::optional<BaseType> { return BaseType::FLT; },
+                 [](bool) -> std::optional<BaseType> { return BaseType::BOOL; },
+                 [](const std::string&) -> std::optional<BaseType> { return BaseType::STRING; },
+                 [](std::monostate) -> std::optional<BaseType> { return std::nullopt; }},
+        expr.get_value());
+}
+
+void Resolver::visit(const IdentifierExpr& expr) {
+    const Symbol identifier = expr.get_symbol();
+    auto slot = find(identifier);
+    expr.set_slot(slot);
+    expr.set_function(!slot && globals ? globals->find(identifier) : nullptr);
+    current_type = slot ? scopes[slot->depth][slot->slot].type : std::nullopt;
+}
+
+void Resolver::visit(const UnaryExpr& expr) {
+    const auto right = infer(expr.get_right());
+    if (!is_numeric(right)) {
+        current_type = std::nullopt;
+    } else {
+        // negation always yields an integer
+        current_type = expr.get_operator() == UnaryOp::NOT ? BaseType::BOOL : BaseType::INT;
+    }
+}
+
+void Resolver::visit(const BinaryExpr& expr) {
+    const auto right = infer(expr.get_right());
+    const auto left = infer(expr.get_left());
+    expr.set_operand_type(left == right ? left : std::nullopt);
+    current_type = binary_result_type(expr.get_operator(), left, right);
+}
+
+void Resolver::visit(const CallExpr& expr) {
+    expr.get_func_name()->accept(*this);
+    for (const auto* arg : expr.get_args()) arg->accept(*this);
+
+    // user-defined functions cast their result into the declared return type
+    current_type = std::nullopt;
+    const auto* name = dynamic_cast<const IdentifierExpr*>(expr.get_func_name());
+    if (!name) return;
+    if (const auto function = std::dynamic_pointer_cast<GlobalFunction>(name->get_function())) {
+        current_type = declared_type(function->get_type()->get_ret_type());
+    }
+}
+
+void Resolver::visit(const BindFrtExpr& expr) {
+    expr.get_func_name()->accept(*this);
+    for (const auto* arg : expr.get_args()) arg->accept(*this);
+    current_type = std::nullopt;
+}
+
+void Resolver::visit(const AssignStatement& stmt) {
+    stmt.get_value()->accept(*this);
+    const Symbol identifier = stmt.get_symbol();
+    auto existing = find(identifier);
+
+    if (!stmt.get_type()) {
+        stmt.set_slot(existing);
+        return;
+    }
+
+    // a re-definition stays unresolved, the interpreter reports it when executed
+    if (existing) {
+        stmt.set_slot(std::nullopt);
+        return;
+    }
+
+    auto& scope = scopes.back();
+    stmt.set_slot(
+        VarSlot{static_cast<uint32_t>(scopes.size() - 1), static_cast<uint32_t>(scope.size())});
+    scope.push_back({identifier, declared_type(stmt.get_type())});
+}
+
+void Resolver::visit(const ForLoopStatement& stmt) {
+    const auto& args = *stmt.get_args();
+    // the iterator is declared in the enclosing scope
+    if (const auto* iterator = std::get_if<std::unique_ptr<Statement>>(&args.iterator)) {
+        (*iterator)->accept(*this);
+    }
+    stmt.get_on_iter()->accept(*this);
+    args.condition->accept(*this);
+    stmt.get_body()->accept(*this);
+}
+
+void Resolver::visit(const WhileLoopStatement& stmt) {
+    stmt.get_condition()->accept(*this);
+    stmt.get_body()->accept(*this);
+}
+
+void Resolver::visit(const ConditionalStatement& stmt) {
+    stmt.get_condition()->accept(*this);
+    stmt.get_body()->accept(*this);
+    if (const auto* else_st = stmt.get_else_st()) else_st->accept(*this);
+}
+
+void Resolver::visit(const ElseStatement& stmt) { stmt.get_body()->accept(*this); }
+
+void Resolver::visit(const RetStatement& stmt) {
+    if (const auto* retval = stmt.get_retval()) retval->accept(*this);
+}
+
+void Resolver::visit(const CallStatement& stmt) { stmt.get_call()->accept(*this); }
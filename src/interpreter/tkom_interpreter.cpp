@@ -1,44 +1,114 @@
-#include <fstream>
 #include <sstream>
 
 #include "tkom_interpreter.h"
+#include "constant_folder.h"
 #include "print_error.h"
 
-TKOMInterpreter::TKOMInterpreter(const std::string& filename, BuiltinVector builtins, bool verbose) : filename(filename), from(From::FILE), verbose(verbose) {
-    std::shared_ptr<std::fstream> input =
-        std::make_shared<std::fstream>(filename, std::fstream::in);
-    std::shared_ptr<Lexer> lexer = std::make_shared<Lexer>(input);
+TKOMInterpreter::TKOMInterpreter(const std::string& filename, BuiltinVector builtins, bool verbose, EngineKind engine, OptLevel opt_level, ParseMode parse_mode, BodyParsing body_parsing, const std::string& cache_file, size_t max_depth) : filename(filename), from(From::FILE), verbose(verbose), engine(engine), opt_level(opt_level), parse_mode(parse_mode), body_parsing(body_parsing) {
+    source = SourceBuffer::from_file(filename);
+    if (!cache_file.empty()) cache.emplace(cache_file, opt_level >= OptLevel::O1);
+    std::shared_ptr<Lexer> lexer = std::make_shared<Lexer>(source);
     parser = std::make_shared<Parser>(std::move(lexer));
+    vm = VirtualMachine(builtins, verbose);
     interpreter = InterpreterVisitor(std::move(builtins));
+    if (max_depth > 0) set_max_depth(max_depth);
 }
 
-TKOMInterpreter::TKOMInterpreter(const std::string& program, From from, BuiltinVector builtins, bool verbose) : filename(program), from(from), verbose(verbose) {
-    std::shared_ptr<std::istream> input;
+TKOMInterpreter::TKOMInterpreter(const std::string& program, From from, BuiltinVector builtins, bool verbose, EngineKind engine, OptLevel opt_level, ParseMode parse_mode, BodyParsing body_parsing, const std::string& cache_file, size_t max_depth) : filename(program), from(from), verbose(verbose), engine(engine), opt_level(opt_level), parse_mode(parse_mode), body_parsing(body_parsing) {
     switch (from) {
-        case From::STRING:
-            input = std::make_unique<std::stringstream>(program);
+        case From::STRING: {
+            std::stringstream input(program);
+            source = SourceBuffer::from_stream(input);
             break;
+        }
         case From::FILE:
-            input = std::make_unique<std::fstream>(program, std::fstream::in);
+            source = SourceBuffer::from_file(program);
             break;
     }
-    std::shared_ptr<Lexer> lexer = std::make_shared<Lexer>(input, verbose);
+    if (!cache_file.empty()) cache.emplace(cache_file, opt_level >= OptLevel::O1);
+    std::shared_ptr<Lexer> lexer = std::make_shared<Lexer>(source, verbose);
     parser = std::make_shared<Parser>(std::move(lexer));
+    vm = VirtualMachine(builtins, verbose);
     interpreter = InterpreterVisitor(std::move(builtins));
+    if (max_depth > 0) set_max_depth(max_depth);
+}
+
+void TKOMInterpreter::set_max_depth(size_t depth) {
+    switch (engine) {
+        case EngineKind::TREE:
+            interpreter.set_max_depth(depth);
+            break;
+        case EngineKind::VM:
+            vm.set_max_depth(depth);
+            break;
+    }
+}
+
+void TKOMInterpreter::prepare(const Function& func) const {
+    if (verbose) {
+        ParserPrinter printer(std::cout);
+        func.accept(printer);
+    }
+    if (opt_level >= OptLevel::O1) {
+        ConstantFolder folder;
+        func.accept(folder);
+    }
+}
+
+auto TKOMInterpreter::run_whole() -> ValType {
+    if (!program) {
+        program = parser->parse();
+        for (const auto* func : program->get_functions()) prepare(*func);
+        // skipped bodies cannot be stored, lazy runs only read the cache
+        if (cache && body_parsing == BodyParsing::EAGER) cache->store(*program, *source);
+    }
+    switch (engine) {
+        case EngineKind::TREE:
+            program->accept(interpreter);
+            return interpreter.get_value();
+        case EngineKind::VM:
+            vm.run(*program);
+            return vm.get_value();
+    }
+    return {};
+}
+
+auto TKOMInterpreter::run_stream() -> ValType {
+    stream = std::make_unique<ProgramStream>(parser, [this](const Function& func) { prepare(func); });
+    ValType value;
+    switch (engine) {
+        case EngineKind::TREE:
+            interpreter.run(*stream);
+            value = interpreter.get_value();
+            break;
+        case EngineKind::VM:
+            vm.run(*stream);
+            value = vm.get_value();
+            break;
+    }
+    // the engines parse the rest of the source once `main` returns, so the stream holds all of it
+    if (cache && body_parsing == BodyParsing::EAGER) cache->store(stream->get_program(), *source);
+    return value;
 }
 
 auto TKOMInterpreter::process() -> int {
     if (!parser) throw ParserError(Position(0, 0), "Uninitialized Parser");
 
+    if (body_parsing == BodyParsing::LAZY) {
+        parser->defer_bodies([this](const Function& func) { prepare(func); });
+    }
+
     ValType ret_code;
     try {
-        program = parser->parse();
-        if (verbose) {
-            ParserPrinter printer(std::cout);
-            program->accept(printer);
+        if (cache) {
+            program = cache->load(*source);
+            if (program && verbose) {
+                ParserPrinter printer(std::cout);
+                program->accept(printer);
+            }
         }
-        program->accept(interpreter);
-        ret_code = interpreter.get_value();
+        // a cached program is complete, there is nothing left to stream
+        ret_code = parse_mode == ParseMode::STREAM && !program ? run_stream() : run_whole();
         if (!std::holds_alternative<int>(ret_code)) {
             throw InterpreterError("main must return an integer value");
         }
@@ -0,0 +1,84 @@
+#include "value_stack.h"
+
+#include <algorithm>
+#include <functional>
+
+auto ValueStack::reserve(size_t needed) -> Chunk& {
+    Chunk* chunk = &chunks[top];
+    if (chunk->values.capacity() - chunk->values.size() >= needed) return *chunk;
+
+    // the variables of a frame are stored next to each other, so the rest of a chunk may go unused
+    if (!chunk->values.empty()) {
+        if (++top == chunks.size()) chunks.emplace_back();
+        chunk = &chunks[top];
+        chunk->base = used;
+    }
+    if (chunk->values.capacity() < needed) {
+        chunk->values = std::vector<Variable>();
+        chunk->values.reserve(std::max(chunk_size, needed));
+    }
+    return *chunk;
+}
+
+auto ValueStack::index_of(const Variable* var, size_t from) const -> std::optional<size_t> {
+    for (size_t i = top + 1; i-- > 0;) {
+        const Chunk& chunk = chunks[i];
+        const Variable* first = chunk.values.data();
+        const Variable* last = first + chunk.values.size();
+        if (!std::less<>()(var, first) && std::less<>()(var, last)) {
+            const size_t index = chunk.base + static_cast<size_t>(var - first);
+            if (index < from) return std::nullopt;
+            return index;
+        }
+        // the chunks below only hold variables under `from`
+        if (chunk.base <= from) break;
+    }
+    return std::nullopt;
+}
+
+auto ValueStack::push(Variable var) -> Variable* {
+    Chunk& chunk = reserve(1);
+    ++used;
+    return &chunk.values.emplace_back(std::move(var));
+}
+
+auto ValueStack::grow(size_t count) -> Variable* {
+    Chunk& chunk = reserve(count);
+    const size_t first = chunk.values.size();
+    chunk.values.resize(first + count);
+    used += count;
+    return chunk.values.data() + first;
+}
+
+void ValueStack::truncate(size_t size) {
+    while (top > 0 && chunks[top].base >= size) chunks[top--].values.clear();
+    auto& values = chunks[top].values;
+    values.erase(values.begin() + static_cast<ptrdiff_t>(size - chunks[top].base), values.end());
+    used = size;
+}
+
+void ValueStack::truncate_keeping(size_t size, ArgVector& args) {
+    std::vector<size_t> kept;
+    for (const auto& arg : args) {
+        auto* const* ref = std::get_if<Variable*>(&arg);
+        if (!ref) continue;
+        if (auto index = index_of(*ref, size)) kept.push_back(*index);
+    }
+    std::ranges::sort(kept);
+    const auto duplicates = std::ranges::unique(kept);
+    kept.erase(duplicates.begin(), duplicates.end());
+
+    // each variable moves down (or stays), never onto one that is still to be moved
+    for (size_t i = 0; i < kept.size(); ++i) {
+        if (size + i != kept[i]) (*this)[size + i] = std::move((*this)[kept[i]]);
+    }
+    for (auto& arg : args) {
+        auto* ref = std::get_if<Variable*>(&arg);
+        if (!ref) continue;
+        if (auto index = index_of(*ref, size)) {
+            *ref = &(*this)[size + static_cast<size_t>(std::ranges::lower_bound(kept, *index) -
+                                                      kept.begin())];
+        }
+    }
+    truncate(size + kept.size());
+}
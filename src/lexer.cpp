@@ -12,6 +12,20 @@ Lexer::Lexer(std::shared_ptr<std::istream> input_stream, bool verbose) : Lexer(i
     this->verbose = verbose;
 }
 
+Lexer::Lexer(std::shared_ptr<const SourceBuffer> source, bool verbose) : verbose(verbose) {
+    position = std::make_shared<Position>();
+    input = std::make_shared<InputManager>(position, std::move(source));
+    tokenizer = std::make_unique<Tokenizer>(input);
+}
+
+Lexer::Lexer(std::shared_ptr<const SourceBuffer> source, size_t offset, Position position,
+             bool verbose)
+    : verbose(verbose) {
+    this->position = std::make_shared<Position>(position);
+    input = std::make_shared<InputManager>(this->position, std::move(source), offset);
+    tokenizer = std::make_unique<Tokenizer>(input);
+}
+
 auto Lexer::get_token() -> Token {
     Token result;
     try {
@@ -28,3 +42,9 @@ auto Lexer::get_token() -> Token {
 }
 
 auto Lexer::end() const -> bool { return eof; }
+
+auto Lexer::get_token_offset() const -> size_t { return tokenizer->get_token_offset(); }
+
+auto Lexer::resume_at(size_t offset, Position position) const -> std::shared_ptr<Lexer> {
+    return std::make_shared<Lexer>(input->get_source(), offset, position, verbose);
+}
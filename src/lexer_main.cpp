@@ -1,5 +1,4 @@
 #include <boost/program_options.hpp>
-#include <fstream>
 #include <iostream>
 
 #include "exceptions.h"
@@ -32,9 +31,7 @@ auto main(int argc, char **argv) -> int {
         return 1;
     }
 
-    std::shared_ptr<std::fstream> input =
-        std::make_unique<std::fstream>(input_file, std::fstream::in);
-    Lexer lexer = Lexer(input, verbose);
+    Lexer lexer = Lexer(SourceBuffer::from_file(input_file), verbose);
     if (verbose)
         std::cout << "--------------------------------\033[36m" << input_file
                   << "\033[0m-------------------------------" << std::endl;
@@ -0,0 +1,15 @@
+#include "arena.h"
+
+auto ArenaAllocated::operator new(size_t size) -> void * {
+    Arena *arena = Arena::current();
+    auto *memory = static_cast<std::byte *>(arena ? arena->allocate(header + size)
+                                                  : ::operator new(header + size));
+    *reinterpret_cast<bool *>(memory) = arena != nullptr;
+    return memory + header;
+}
+
+void ArenaAllocated::operator delete(void *ptr, size_t size) noexcept {
+    if (!ptr) return;
+    auto *memory = static_cast<std::byte *>(ptr) - header;
+    if (!*reinterpret_cast<bool *>(memory)) ::operator delete(memory, header + size);
+}
@@ -7,11 +7,3 @@ Block::Block(std::vector<std::unique_ptr<Statement>> statements)
 
 void Block::accept(Visitor &visitor) const { visitor.visit(*this); }
 
-auto Block::get_statements() const -> std::vector<const Statement *> {
-    std::vector<const Statement *> result;
-    result.reserve(statements.size());
-    for (const auto &stmt : statements) {
-        result.push_back(stmt.get());
-    }
-    return result;
-}
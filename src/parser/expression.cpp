@@ -15,6 +15,9 @@ LiteralExpr::LiteralExpr(const Position pos, Token token)
     LiteralExpr::type = *type;
 }
 
+LiteralExpr::LiteralExpr(const Position pos, BaseType type, ValueType value)
+    : Expression(pos), type(type), value(std::move(value)) {}
+
 void LiteralExpr::accept(Visitor &visitor) const { visitor.visit(*this); }
 
 struct LiteralString {
@@ -30,10 +33,9 @@ auto LiteralExpr::get_value_string() const -> std::string {
 
 /* ----------------------------[IDENTIFIER]--------------------------------*/
 
-IdentifierExpr::IdentifierExpr(const Position pos, std::string identifier)
-    : Expression(pos), identifier(std::move(identifier)) {}
+IdentifierExpr::IdentifierExpr(const Position pos, Symbol identifier)
+    : Expression(pos), identifier(identifier) {}
 
-auto IdentifierExpr::get_identifier() const -> std::string { return identifier; }
 void IdentifierExpr::accept(Visitor &visitor) const { visitor.visit(*this); }
 
 /* ------------------------------[UNARY]--------------------------------*/
@@ -69,15 +71,6 @@ CallExpr::CallExpr(Position pos, std::unique_ptr<Expression> name,
 
 auto CallExpr::get_func_name() const -> const Expression * { return func_name.get(); }
 
-auto CallExpr::get_args() const -> const std::vector<const Expression *> {
-    std::vector<const Expression *> result;
-    result.reserve(args.size());
-    for (const auto &arg : args) {
-        result.push_back(arg.get());
-    }
-    return result;
-}
-
 void CallExpr::accept(Visitor &visitor) const { visitor.visit(*this); }
 
 /* ------------------------------[BINDFRT]--------------------------------*/
@@ -90,11 +83,3 @@ void BindFrtExpr::accept(Visitor &visitor) const { visitor.visit(*this); }
 
 auto BindFrtExpr::get_func_name() const -> const Expression * { return func_name.get(); }
 
-auto BindFrtExpr::get_args() const -> const std::vector<const Expression *> {
-    std::vector<const Expression *> result;
-    result.reserve(args.size());
-    for (const auto &arg : args) {
-        result.push_back(arg.get());
-    }
-    return result;
-}
@@ -8,8 +8,8 @@
 #include "visitor.h"
 
 FuncSignature::FuncSignature(Position pos, std::unique_ptr<Type> ret,
-                             std::vector<std::unique_ptr<VariableSignature>> args, std::string name)
-    : Node(pos), ret_type(std::move(ret)), args(std::move(args)), name(std::move(name)) {}
+                             std::vector<std::unique_ptr<VariableSignature>> args, Symbol name)
+    : Node(pos), ret_type(std::move(ret)), args(std::move(args)), name(name) {}
 
 void FuncSignature::accept(Visitor &visitor) const { visitor.visit(*this); }
 
@@ -21,23 +21,23 @@ auto FuncSignature::clone_type_as_type_obj() const -> std::unique_ptr<FuncType>
     return std::make_unique<FuncType>(ret_type->clone(), std::move(params));
 }
 
-auto FuncSignature::get_name() const -> std::string { return name; }
-
-auto FuncSignature::get_params() const -> const std::vector<const VariableSignature *> {
-    std::vector<const VariableSignature *> params;
-    for (auto &param : args) {
-        params.push_back(param.get());
-    }
-    return params;
-}
-
 Function::Function(std::unique_ptr<FuncSignature> signature, std::unique_ptr<Block> body)
-    : signature(std::move(signature)), body(std::move(body)) {
-    Function::Node(Function::signature->get_position());
-}
+    : Node(signature->get_position()), signature(std::move(signature)), body(std::move(body)) {}
+
+Function::Function(std::unique_ptr<FuncSignature> signature, BodyLoader body_loader)
+    : Node(signature->get_position()),
+      signature(std::move(signature)),
+      body_loader(std::move(body_loader)) {}
 
 void Function::accept(Visitor &visitor) const { visitor.visit(*this); }
 
+auto Function::parse_body() const -> bool {
+    if (!body_loader) return false;
+    // the loader is released before it runs, a failed parse is not retried
+    std::exchange(body_loader, nullptr)(*this);
+    return true;
+}
+
 auto Function::get_signature() const -> const FuncSignature * { return signature.get(); }
 
 auto Function::get_body() const -> const Block * { return body.get(); }
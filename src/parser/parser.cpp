@@ -9,32 +9,86 @@ Parser::Parser(std::shared_ptr<Lexer> lexer) : lexer(std::move(lexer)) {}
  */
 
 auto Parser::parse() -> ProgramPtr {
-    std::vector<std::unique_ptr<Function>> functions;
-    FuncPtr function;
+    // the whole tree is laid out in parse order within the program's arena
+    ProgramPtr program = std::make_unique<Program>(std::vector<std::unique_ptr<Function>>(),
+                                                   std::make_unique<Arena>());
+    while (parse_function(*program)) {
+    }
+    return program;
+}
 
-    next_token();
-    while (auto function = parse_func_def()) {
-        functions.push_back(std::move(function));
+auto Parser::parse_function(Program& program) -> const Function* {
+    std::optional<Arena::Scope> arena_scope;
+    if (Arena* arena = program.get_arena()) arena_scope.emplace(*arena);
+
+    if (!started) {
+        next_token();
+        started = true;
     }
-    shall(is_token(TokenType::T_EOF), "Expected function def");
 
-    ProgramPtr program = std::make_unique<Program>(std::move(functions));
-    return program;
+    FuncPtr function = parse_func_def();
+    if (!function) {
+        shall(is_token(TokenType::T_EOF), "Expected function def");
+        return nullptr;
+    }
+
+    const Function* parsed = function.get();
+    program.add_function(std::move(function));
+    return parsed;
 }
 
 /*
  *      function_def = func_signature, block
  */
 
+void Parser::defer_bodies(std::function<void(const Function&)> on_body) {
+    defer = true;
+    this->on_body = std::move(on_body);
+}
+
 auto Parser::parse_func_def() -> FuncPtr {
     FuncSignPtr signature = parse_func_signature();
     if (!signature) return nullptr;
 
+    if (defer && is_token(TokenType::T_LBLOCK)) {
+        return std::make_unique<Function>(std::move(signature), skip_block());
+    }
+
     BlockPtr body = shall(parse_block(), "Expected block");
 
     return std::make_unique<Function>(std::move(signature), std::move(body));
 }
 
+auto Parser::skip_block() -> BodyLoader {
+    // the opening brace is the last token read, the body is parsed again starting from it
+    const size_t offset = lexer->get_token_offset();
+    const Position pos = get_position();
+
+    size_t depth = 0;
+    do {
+        if (is_token(TokenType::T_LBLOCK)) {
+            ++depth;
+        } else if (is_token(TokenType::T_RBLOCK)) {
+            --depth;
+        } else if (is_token(TokenType::T_EOF)) {
+            throw ParserError(get_position(), "Expected }");
+        }
+        next_token();
+    } while (depth > 0);
+
+    return [lexer = lexer, offset, pos, arena = Arena::current(),
+            on_body = on_body](const Function& func) {
+        {
+            std::optional<Arena::Scope> arena_scope;
+            if (arena) arena_scope.emplace(*arena);
+            Parser parser(lexer->resume_at(offset, pos));
+            parser.next_token();
+            func.set_body(parser.shall(parser.parse_block(), "Expected block"));
+        }
+        if (on_body) on_body(func);
+    };
+}
+
 /*
  *      func_signature  = type, identifier, [function_sign_op,
  * function_def_params] func_def_params = func_param, {",",
@@ -50,7 +104,7 @@ auto Parser::parse_func_signature() -> FuncSignPtr {
 
     shall(is_token(TokenType::T_IDENTIFIER), "Expected function identifier");
 
-    auto func_name = current_token.get_value<std::string>();
+    auto func_name = Symbol(current_token.get_text());
     std::vector<std::unique_ptr<VariableSignature>> params;
 
     if (!is_next_token(TokenType::T_FUNC_SIGN)) {
@@ -76,7 +130,7 @@ auto Parser::parse_func_signature() -> FuncSignPtr {
 auto Parser::parse_func_param() -> ParamPtr {
     TypePtr current_arg_type = shall(parse_type(), "Expected type");
     shall(is_token(TokenType::T_IDENTIFIER), "Expected parameter name");
-    const auto val = current_token.get_value<std::string>();
+    const auto val = Symbol(current_token.get_text());
     next_token();
     return std::make_unique<VariableSignature>(std::move(current_arg_type), val);
 }
@@ -150,7 +204,7 @@ auto Parser::parse_assign_or_call() -> StatementPtr {
     TypePtr type = parse_type();
 
     shall(is_token(TokenType::T_IDENTIFIER), "Expected identifier");
-    const auto val = current_token.get_value<std::string>();
+    const auto val = Symbol(current_token.get_text());
     next_token();
 
     ParamPtr signature =
@@ -214,7 +268,7 @@ auto Parser::parse_for_loop_args() -> ForLoopArgsPtr {
 
     next_token();
     StatementPtr assign = parse_assign_or_call();
-    std::variant<StatementPtr, std::string> iterator;
+    std::variant<StatementPtr, Symbol> iterator;
     if (!assign) {
         shall(is_token(TokenType::T_IDENTIFIER), "Expected assign or identifier");
         auto identifier = current_token.get_value<std::string>();
@@ -515,7 +569,7 @@ auto Parser::parse_decorator() -> ExprPtr {
 
 auto Parser::parse_identifier() -> ExprPtr {
     if (!is_token(TokenType::T_IDENTIFIER)) return nullptr;
-    auto value = current_token.get_value<std::string>();
+    auto value = Symbol(current_token.get_text());
     const Position pos = get_position();
 
     next_token();
@@ -100,5 +100,6 @@ void AssignStatement::accept(Visitor &visitor) const { visitor.visit(*this); }
 
 auto AssignStatement::get_value() const -> const Expression * { return value.get(); }
 auto AssignStatement::get_type() const -> const Type * { return var_sign->get_type(); }
-auto AssignStatement::get_identifier() const -> const std::string { return var_sign->get_name(); }
+auto AssignStatement::get_identifier() const -> const std::string & { return var_sign->get_name(); }
+auto AssignStatement::get_symbol() const -> Symbol { return var_sign->get_symbol(); }
 auto AssignStatement::get_signature() const -> const VariableSignature * { return var_sign.get(); }
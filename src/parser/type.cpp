@@ -68,15 +68,6 @@ FuncType::FuncType(std::unique_ptr<Type> ret_type, std::vector<std::unique_ptr<T
 
 auto FuncType::get_ret_type() const -> const Type * { return ret_type.get(); }
 
-auto FuncType::get_params() const -> std::vector<const Type *> {
-    std::vector<const Type *> result;
-    result.reserve(params.size());
-    for (const auto &param : params) {
-        result.push_back(param.get());
-    }
-    return result;
-}
-
 void FuncType::accept(Visitor &visitor) const { visitor.visit(*this); }
 
 auto VarType::is_equal_to(const Type *other) const -> bool {
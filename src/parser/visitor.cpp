@@ -141,7 +141,7 @@ void ParserPrinter::visit(const VarType &type) {
 
 void ParserPrinter::visit(const Block &block) {
     increase_indent();
-    for (auto &stmt : block.get_statements()) {
+    for (const auto *stmt : block.get_statements()) {
         stmt->accept(*this);
     }
     decrease_indent();
@@ -158,7 +158,7 @@ void ParserPrinter::visit(const FuncType &type) {
 
     os << "::";
     bool first_done = false;
-    for (auto &param : type.get_params()) {
+    for (const auto *param : type.get_params()) {
         if (first_done) {
             os << ",";
         } else {
@@ -186,7 +186,7 @@ void ParserPrinter::visit(const FuncSignature &sign) {
     os << std::endl;
     os << "┃ PARAMS: ";
     bool first = true;
-    for (auto &param : sign.get_params()) {
+    for (const auto *param : sign.get_params()) {
         if (!first) {
             os << ", ";
         } else {
@@ -202,7 +202,11 @@ void ParserPrinter::visit(const Function &func) {
     os << "┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━";
     os << std::endl;
     increase_indent();
-    func.get_body()->accept(*this);
+    if (const auto* body = func.get_body()) {
+        body->accept(*this);
+    } else {
+        os << indent_str() << "└[Body not parsed yet]" << std::endl;
+    }
     decrease_indent();
     os << "┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━";
     os << std::endl;
@@ -1,5 +1,4 @@
 #include <boost/program_options.hpp>
-#include <fstream>
 #include <iostream>
 
 #include "exceptions.h"
@@ -35,9 +34,8 @@ auto main(int argc, char **argv) -> int {
         return 1;
     }
 
-    std::shared_ptr<std::fstream> input =
-        std::make_unique<std::fstream>(input_file, std::fstream::in);
-    std::shared_ptr<Lexer> lexer = std::make_shared<Lexer>(input, verbose);
+    std::shared_ptr<Lexer> lexer =
+        std::make_shared<Lexer>(SourceBuffer::from_file(input_file), verbose);
     Parser parser = Parser(std::move(lexer));
     std::unique_ptr<Program> program;
     if (verbose)
@@ -2,16 +2,42 @@
 #include <iostream>
 
 #include "builtin_defines.h"
+#include "program_cache.h"
 #include "tkom_interpreter.h"
 
 namespace po = boost::program_options;
 
 auto main(int argc, char **argv) -> int {
     std::string input_file;
+    std::string engine_name;
+    std::string cache_dir;
     bool verbose = false;
+    bool stream = false;
+    bool lazy = false;
+    bool cache = false;
+    int opt_level = 1;
+    // signed, so that negative depths are rejected instead of wrapping around
+    long long max_stack = 0;
+
+    const std::string max_stack_help =
+        "maximal depth of nested calls (default: " +
+        std::to_string(VirtualMachine::default_max_depth) + " for vm, " +
+        std::to_string(InterpreterVisitor::default_max_depth) + " for tree)";
 
     po::options_description desc("Allowed options");
     desc.add_options()("verbose,V", po::bool_switch(&verbose), "enable verbose output")(
+        "engine", po::value<std::string>(&engine_name)->default_value("vm"),
+        "execution engine: vm (bytecode) or tree (reference interpreter)")(
+        "optimize,O", po::value<int>(&opt_level)->default_value(1),
+        "optimization level: 0 (none) or 1 (constant folding)")(
+        "stream", po::bool_switch(&stream),
+        "start running main before the rest of the program is parsed")(
+        "lazy", po::bool_switch(&lazy), "parse the body of a function on its first call")(
+        "cache", po::bool_switch(&cache),
+        "reuse the parsed program across runs, storing it next to the source")(
+        "cache-dir", po::value<std::string>(&cache_dir),
+        "store the parsed program in the given directory, implies --cache")(
+        "max-stack", po::value<long long>(&max_stack), max_stack_help.c_str())(
         "input", po::value<std::string>(&input_file), "input file")("help,h", "show help message");
 
     po::positional_options_description pos_desc;
@@ -31,6 +57,37 @@ auto main(int argc, char **argv) -> int {
         return 1;
     }
 
-    TKOMInterpreter interpreter{input_file, builtins, verbose};
+    EngineKind engine = EngineKind::VM;
+    if (engine_name == "tree") {
+        engine = EngineKind::TREE;
+    } else if (engine_name != "vm") {
+        std::cout << "\033[1;31mError:\033[0m Unknown engine: " << engine_name << std::endl;
+        return 1;
+    }
+
+    if (opt_level != 0 && opt_level != 1) {
+        std::cout << "\033[1;31mError:\033[0m Unknown optimization level: " << opt_level
+                  << std::endl;
+        return 1;
+    }
+
+    // each engine bounds the depth by what its call stack can hold
+    const auto max_stack_limit = static_cast<long long>(engine == EngineKind::TREE
+                                                            ? InterpreterVisitor::max_depth_limit
+                                                            : VirtualMachine::max_depth_limit);
+    if (vm.count("max-stack") && (max_stack < 1 || max_stack > max_stack_limit)) {
+        std::cout << "\033[1;31mError:\033[0m Invalid maximal depth of nested calls: " << max_stack
+                  << " (expected 1 to " << max_stack_limit << ")" << std::endl;
+        return 1;
+    }
+
+    std::string cache_file;
+    if (cache || !cache_dir.empty()) cache_file = ProgramCache::path_for(input_file, cache_dir);
+
+    TKOMInterpreter interpreter{input_file, builtins, verbose, engine,
+                                static_cast<OptLevel>(opt_level),
+                                stream ? ParseMode::STREAM : ParseMode::WHOLE,
+                                lazy ? BodyParsing::LAZY : BodyParsing::EAGER, cache_file,
+                                static_cast<size_t>(max_stack)};
     return interpreter.process();
 }
@@ -0,0 +1,55 @@
+#include "symbol.h"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * @brief hash allowing lookups of `std::string_view` in a set of strings
+ */
+struct NameHash {
+    using is_transparent = void;
+    auto operator()(std::string_view name) const noexcept -> size_t {
+        return std::hash<std::string_view>{}(name);
+    }
+};
+
+/**
+ * @brief the process-wide table of interned names
+ *
+ * Elements of an unordered set never move, so symbols may point to them directly
+ */
+struct SymbolTable {
+    std::mutex mutex;
+    std::unordered_set<std::string, NameHash, std::equal_to<>> names;
+};
+
+auto table() -> SymbolTable & {
+    static SymbolTable symbols;
+    return symbols;
+}
+
+}  // namespace
+
+Symbol::Symbol() : Symbol(std::string_view()) {}
+
+Symbol::Symbol(std::string_view name) {
+    auto &symbols = table();
+    std::lock_guard lock(symbols.mutex);
+    auto interned = symbols.names.find(name);
+    if (interned == symbols.names.end()) interned = symbols.names.emplace(name).first;
+    this->name = &*interned;
+}
+
+auto Symbol::find(std::string_view name) -> std::optional<Symbol> {
+    auto &symbols = table();
+    std::lock_guard lock(symbols.mutex);
+    auto interned = symbols.names.find(name);
+    if (interned == symbols.names.end()) return std::nullopt;
+    return Symbol(&*interned);
+}
+
+auto operator<<(std::ostream &os, const Symbol &symbol) -> std::ostream & {
+    return os << symbol.str();
+}
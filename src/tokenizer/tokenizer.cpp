@@ -3,6 +3,7 @@
 #include <cmath>
 #include <utility>
 
+#include "char_scan.h"
 #include "exceptions.h"
 
 Tokenizer::Tokenizer(std::shared_ptr<InputManager> input) : input(std::move(input)) {}
@@ -17,46 +18,52 @@ auto Tokenizer::get_token() -> Token {
 auto Tokenizer::start_build_token(Position& pos) -> Token {
     char current_char = input->get_next_char();
     while (current_char != EOF) {
-        if (!std::isspace(current_char)) {
+        if (char_classes[static_cast<unsigned char>(current_char)] != CharClass::SPACE) {
+            // the character was just read, or handed back, and lies right before the cursor
+            token_offset = input->get_cursor() - 1 - input->get_source()->data();
             return build_token(current_char);
-        } else {
-            pos = input->save_position();
-            current_char = input->get_next_char();
         }
+        // indentation and spacing come in runs, line breaks are taken one at a time
+        input->advance_to(scan_blanks(input->get_cursor(), input->get_limit()));
+        pos = input->save_position();
+        current_char = input->get_next_char();
     }
     return {TokenType::T_EOF};
 }
 
 auto Tokenizer::build_token(char current_char) -> Token {
-    OptToken token = build_identifier(current_char);
-    if (token) return *token;
-
-    token = build_number(current_char);
-    if (token) return *token;
-
-    token = build_string(current_char);
-    if (token) return *token;
-
-    token = build_short_operator(current_char);
-    if (token) return *token;
-
-    token = start_build_long_operator(current_char);
-    if (token) return *token;
-
-    throw UnexpectedToken();
+    switch (char_classes[static_cast<unsigned char>(current_char)]) {
+        case CharClass::LETTER:
+            return build_identifier();
+        case CharClass::DIGIT:
+            return build_number(current_char);
+        case CharClass::QUOTE:
+            return build_string();
+        case CharClass::OPERATOR:
+            return build_long_operator(operator_tokens[static_cast<unsigned char>(current_char)]);
+        case CharClass::OPERATOR_START:
+            return start_build_long_operator(current_char);
+        default:
+            throw UnexpectedToken();
+    }
 }
 
-auto Tokenizer::build_identifier(char current_char) const -> OptToken {
-    if (!std::isalpha(current_char)) return std::nullopt;
-
-    std::string identifier = "";
-    unsigned short length = 0;
-    while (isalnum(current_char) || current_char == '_') {
-        identifier += current_char;
-        length++;
-        if (length >= 32) throw IdentifierLengthExceeded();
-        current_char = input->get_next_char();
+auto Tokenizer::build_identifier() const -> Token {
+    // the first character was just read, identifiers never span a line break
+    const char* start = input->get_cursor() - 1;
+    const char* limit = input->get_limit();
+    if (limit - start > identifier_length_limit) limit = start + identifier_length_limit;
+    const char* end = scan_identifier(input->get_cursor(), limit);
+    if (end - start >= identifier_length_limit) {
+        input->advance_to(end);
+        throw IdentifierLengthExceeded();
     }
+    input->advance_to(end);
+    // read the character ending the identifier, so that the end of the document is noticed
+    input->get_next_char();
+    input->unget();
+
+    const std::string_view identifier(start, end - start);
     MapTokenType keyword = get_keyword_for_string(identifier);
     Token result;
     if (keyword.index()) {
@@ -66,15 +73,12 @@ auto Tokenizer::build_identifier(char current_char) const -> OptToken {
         }
     } else {
         result.set_type(TokenType::T_IDENTIFIER);
-        result.set_value<std::string>(identifier);
+        result.set_value(identifier);
     }
-    input->unget();
     return result;
 }
 
-auto Tokenizer::build_number(char current_char) const -> OptToken {
-    if (!std::isdigit(current_char)) return std::nullopt;
-
+auto Tokenizer::build_number(char current_char) const -> Token {
     unsigned long number = 0;
     bool floating = false;
     unsigned short decimal_places = 0;
@@ -108,36 +112,33 @@ auto Tokenizer::build_number(char current_char) const -> OptToken {
     return result;
 }
 
-auto Tokenizer::build_string(char current_char) const -> OptToken {
-    if (current_char != '"') return std::nullopt;
-
-    std::string value = "";
-    current_char = input->get_next_char();
-    while (current_char != '"') {
+auto Tokenizer::build_string() -> Token {
+    // the literal is used in place, unless it contains escape sequences
+    const char* start = input->get_cursor();
+    std::string* value = nullptr;
+    while (true) {
+        const char* run = input->get_cursor();
+        const char* run_end = scan_string_body(run, input->get_limit());
+        input->advance_to(run_end);
+        if (value) value->append(run, run_end);
+
+        char current_char = input->get_next_char();
+        if (current_char == '"') break;
+        if (current_char == '\n' || current_char == EOF) throw UnterminatedString();
         if (current_char == '\\') {
+            if (!value) value = &unescaped.emplace_back(start, run_end);
             current_char = get_char_for_escape(input->get_next_char());
-        } else if (current_char == '\n') {
-            throw UnterminatedString();
         }
-        value += current_char;
-        current_char = input->get_next_char();
+        if (value) *value += current_char;
     }
+    const std::string_view text(start, input->get_cursor() - 1 - start);
     Token result = Token(TokenType::T_STRING);
-    result.set_value<std::string>(value);
+    result.set_value(value ? std::string_view(*value) : text);
     return result;
 }
 
-auto Tokenizer::build_short_operator(char current_char) const -> OptToken {
-    if (!operator_tokens.count(current_char)) return std::nullopt;
-
-    TokenType type = std::get<TokenType>(get_type_for_operator(current_char));
-    return build_long_operator(type);
-}
-
-auto Tokenizer::start_build_long_operator(char current_char) const -> OptToken {
-    if (!first_char_tokens.count(current_char)) return std::nullopt;
-
-    TokenType type = std::get<TokenType>(get_type_for_first_op_char(current_char));
+auto Tokenizer::start_build_long_operator(char current_char) const -> Token {
+    TokenType type = operator_tokens[static_cast<unsigned char>(current_char)];
     current_char = input->get_next_char();
     MapTokenType new_type = get_type_for_long_op(current_char, type);
     if (new_type.index()) {
@@ -147,7 +148,7 @@ auto Tokenizer::start_build_long_operator(char current_char) const -> OptToken {
     }
 }
 
-auto Tokenizer::build_long_operator(TokenType type) const -> OptToken {
+auto Tokenizer::build_long_operator(TokenType type) const -> Token {
     MapTokenType new_type = type;
     char current_char;
     do {
@@ -160,39 +161,51 @@ auto Tokenizer::build_long_operator(TokenType type) const -> OptToken {
     return Token(type);
 }
 
-auto Tokenizer::get_type_for_operator(char c) const -> MapTokenType {
-    auto it = operator_tokens.find(c);
-    if (it != operator_tokens.end()) {
-        return it->second;
-    } else {
-        return {std::monostate()};
-    }
-}
-
-auto Tokenizer::get_type_for_first_op_char(char c) const -> MapTokenType {
-    auto it = first_char_tokens.find(c);
-    if (it != first_char_tokens.end()) {
-        return it->second;
-    } else {
-        return {std::monostate()};
-    }
-}
-
-auto Tokenizer::get_type_for_long_op(char c, TokenType type) const -> MapTokenType {
-    std::pair<char, TokenType> pair = std::pair<char, TokenType>(c, type);
-    auto it = long_operator_tokens.find(pair);
-    if (it == long_operator_tokens.end()) {
-        return {std::monostate()};
+auto Tokenizer::get_type_for_long_op(char c, TokenType type) -> MapTokenType {
+    switch (type) {
+        case TokenType::T_MINUS:
+            if (c == '>') return TokenType::T_CALL;
+            break;
+        case TokenType::T_CALL:
+            if (c == '>') return TokenType::T_BINDFRT;
+            break;
+        case TokenType::T_NOT:
+            if (c == '=') return TokenType::T_NEQ;
+            break;
+        case TokenType::T_GT:
+            if (c == '=') return TokenType::T_GTE;
+            break;
+        case TokenType::T_LT:
+            if (c == '=') return TokenType::T_LTE;
+            break;
+        case TokenType::T_EQ_ST:
+            if (c == '>') return TokenType::T_ASSIGN;
+            if (c == '=') return TokenType::T_EQ;
+            break;
+        case TokenType::T_AND_ST:
+            if (c == '&') return TokenType::T_AND;
+            break;
+        case TokenType::T_OR_ST:
+            if (c == '|') return TokenType::T_OR;
+            break;
+        case TokenType::T_DIV:
+            if (c == '/') return TokenType::T_COMMENT;
+            break;
+        case TokenType::T_FUNC_SIGN_ST:
+            if (c == ':') return TokenType::T_FUNC_SIGN;
+            break;
+        default:
+            break;
     }
-    return it->second;
+    return {std::monostate()};
 }
 
-auto Tokenizer::get_keyword_for_string(std::string value) const -> MapTokenType {
-    auto it = keyword_tokens.find(value);
-    if (it == keyword_tokens.end()) {
+auto Tokenizer::get_keyword_for_string(std::string_view value) -> MapTokenType {
+    const Keyword& keyword = keyword_tokens[keyword_hash(value)];
+    if (keyword.text != value) {
         return {std::monostate()};
     }
-    return it->second;
+    return keyword.type;
 }
 
 auto Tokenizer::get_char_for_escape(char c) const -> char {
@@ -206,49 +219,72 @@ auto Tokenizer::get_char_for_escape(char c) const -> char {
     }
 }
 
-const std::unordered_map<std::string, TokenType> Tokenizer::keyword_tokens{
-    {"int", TokenType::T_INT_TYPE},
-    {"flt", TokenType::T_FLT_TYPE},
-    {"string", TokenType::T_STRING_TYPE},
-    {"int", TokenType::T_INT_TYPE},
-    {"void", TokenType::T_VOID_TYPE},
-    {"ret", TokenType::T_RET},
-    {"while", TokenType::T_WHILE},
-    {"for", TokenType::T_FOR},
-    {"if", TokenType::T_IF},
-    {"elif", TokenType::T_ELIF},
-    {"else", TokenType::T_ELSE},
-    {"mut", TokenType::T_MUT},
-    {"bool", TokenType::T_BOOL_TYPE},
-    {"true", TokenType::T_BOOL},
-    {"false", TokenType::T_BOOL},
-};
-
-const std::unordered_map<char, TokenType> Tokenizer::operator_tokens{
-    {'-', TokenType::T_MINUS},    {'+', TokenType::T_PLUS},      {'*', TokenType::T_MULT},
-    {'/', TokenType::T_DIV},      {'@', TokenType::T_DECORATE},  {'-', TokenType::T_MINUS},
-    {'!', TokenType::T_NOT},      {'>', TokenType::T_GT},        {'<', TokenType::T_LT},
-    {'(', TokenType::T_LPAREN},   {')', TokenType::T_RPAREN},    {'{', TokenType::T_LBLOCK},
-    {'}', TokenType::T_RBLOCK},   {';', TokenType::T_SEMICOLON}, {',', TokenType::T_COMMA},
-    {'_', TokenType::T_WILDCARD}, {'[', TokenType::T_LFTYPE},    {']', TokenType::T_RFTYPE}};
-
-const std::map<std::pair<char, TokenType>, TokenType> Tokenizer::long_operator_tokens{
-    {std::pair<char, TokenType>('>', TokenType::T_MINUS), TokenType::T_CALL},
-    {std::pair<char, TokenType>('>', TokenType::T_CALL), TokenType::T_BINDFRT},
-    {std::pair<char, TokenType>('=', TokenType::T_NOT), TokenType::T_NEQ},
-    {std::pair<char, TokenType>('=', TokenType::T_GT), TokenType::T_GTE},
-    {std::pair<char, TokenType>('=', TokenType::T_LT), TokenType::T_LTE},
-    {std::pair<char, TokenType>('>', TokenType::T_EQ_ST), TokenType::T_ASSIGN},
-    {std::pair<char, TokenType>('=', TokenType::T_EQ_ST), TokenType::T_EQ},
-    {std::pair<char, TokenType>('&', TokenType::T_AND_ST), TokenType::T_AND},
-    {std::pair<char, TokenType>('|', TokenType::T_OR_ST), TokenType::T_OR},
-    {std::pair<char, TokenType>('/', TokenType::T_DIV), TokenType::T_COMMENT},
-    {std::pair<char, TokenType>(':', TokenType::T_FUNC_SIGN_ST), TokenType::T_FUNC_SIGN},
-};
-
-const std::unordered_map<char, TokenType> Tokenizer::first_char_tokens{
-    {'=', TokenType::T_EQ_ST},
-    {'|', TokenType::T_OR_ST},
-    {'&', TokenType::T_AND_ST},
-    {':', TokenType::T_FUNC_SIGN_ST},
-};
+const std::array<Keyword, Tokenizer::keyword_slots> Tokenizer::keyword_tokens = [] {
+    constexpr std::array<Keyword, 14> keywords{{
+        {"int", TokenType::T_INT_TYPE},
+        {"flt", TokenType::T_FLT_TYPE},
+        {"string", TokenType::T_STRING_TYPE},
+        {"void", TokenType::T_VOID_TYPE},
+        {"ret", TokenType::T_RET},
+        {"while", TokenType::T_WHILE},
+        {"for", TokenType::T_FOR},
+        {"if", TokenType::T_IF},
+        {"elif", TokenType::T_ELIF},
+        {"else", TokenType::T_ELSE},
+        {"mut", TokenType::T_MUT},
+        {"bool", TokenType::T_BOOL_TYPE},
+        {"true", TokenType::T_BOOL},
+        {"false", TokenType::T_BOOL},
+    }};
+    // built at compile time, a hash collision between keywords fails the build
+    constexpr auto table = [&] {
+        std::array<Keyword, keyword_slots> table{};
+        for (const auto& keyword : keywords) {
+            auto& slot = table[keyword_hash(keyword.text)];
+            if (!slot.text.empty()) throw "keyword hash collision";
+            slot = keyword;
+        }
+        return table;
+    }();
+    return table;
+}();
+
+const std::array<CharClass, 256> Tokenizer::char_classes = [] {
+    std::array<CharClass, 256> classes{};
+    for (unsigned char c : std::string_view(" \t\n\v\f\r")) classes[c] = CharClass::SPACE;
+    for (int c = 'a'; c <= 'z'; ++c) classes[c] = CharClass::LETTER;
+    for (int c = 'A'; c <= 'Z'; ++c) classes[c] = CharClass::LETTER;
+    for (int c = '0'; c <= '9'; ++c) classes[c] = CharClass::DIGIT;
+    classes['"'] = CharClass::QUOTE;
+    for (unsigned char c : std::string_view("-+*/@!><(){};,_[]")) classes[c] = CharClass::OPERATOR;
+    for (unsigned char c : std::string_view("=|&:")) classes[c] = CharClass::OPERATOR_START;
+    return classes;
+}();
+
+const std::array<TokenType, 256> Tokenizer::operator_tokens = [] {
+    std::array<TokenType, 256> types{};
+    types.fill(TokenType::T_ERROR);
+    types['-'] = TokenType::T_MINUS;
+    types['+'] = TokenType::T_PLUS;
+    types['*'] = TokenType::T_MULT;
+    types['/'] = TokenType::T_DIV;
+    types['@'] = TokenType::T_DECORATE;
+    types['!'] = TokenType::T_NOT;
+    types['>'] = TokenType::T_GT;
+    types['<'] = TokenType::T_LT;
+    types['('] = TokenType::T_LPAREN;
+    types[')'] = TokenType::T_RPAREN;
+    types['{'] = TokenType::T_LBLOCK;
+    types['}'] = TokenType::T_RBLOCK;
+    types[';'] = TokenType::T_SEMICOLON;
+    types[','] = TokenType::T_COMMA;
+    types['_'] = TokenType::T_WILDCARD;
+    types['['] = TokenType::T_LFTYPE;
+    types[']'] = TokenType::T_RFTYPE;
+    // first characters of operators that must be extended
+    types['='] = TokenType::T_EQ_ST;
+    types['|'] = TokenType::T_OR_ST;
+    types['&'] = TokenType::T_AND_ST;
+    types[':'] = TokenType::T_FUNC_SIGN_ST;
+    return types;
+}();
@@ -0,0 +1,113 @@
+#include "bytecode.h"
+
+#include <iomanip>
+
+auto operator<<(std::ostream& os, OpCode op) -> std::ostream& {
+    switch (op) {
+        case OpCode::LOAD_CONST:
+            return os << "LOAD_CONST";
+        case OpCode::LOAD_LOCAL:
+            return os << "LOAD_LOCAL";
+        case OpCode::DECLARE:
+            return os << "DECLARE";
+        case OpCode::STORE:
+            return os << "STORE";
+        case OpCode::ADD:
+            return os << "ADD";
+        case OpCode::SUB:
+            return os << "SUB";
+        case OpCode::MULT:
+            return os << "MULT";
+        case OpCode::DIV:
+            return os << "DIV";
+        case OpCode::LT:
+            return os << "LT";
+        case OpCode::LTE:
+            return os << "LTE";
+        case OpCode::GT:
+            return os << "GT";
+        case OpCode::GTE:
+            return os << "GTE";
+        case OpCode::EQ:
+            return os << "EQ";
+        case OpCode::NEQ:
+            return os << "NEQ";
+        case OpCode::AND:
+            return os << "AND";
+        case OpCode::OR:
+            return os << "OR";
+        case OpCode::DECORATE:
+            return os << "DECORATE";
+        case OpCode::NOT:
+            return os << "NOT";
+        case OpCode::NEG:
+            return os << "NEG";
+        case OpCode::ADD_INT:
+            return os << "ADD_INT";
+        case OpCode::SUB_INT:
+            return os << "SUB_INT";
+        case OpCode::MULT_INT:
+            return os << "MULT_INT";
+        case OpCode::LT_INT:
+            return os << "LT_INT";
+        case OpCode::LTE_INT:
+            return os << "LTE_INT";
+        case OpCode::GT_INT:
+            return os << "GT_INT";
+        case OpCode::GTE_INT:
+            return os << "GTE_INT";
+        case OpCode::EQ_INT:
+            return os << "EQ_INT";
+        case OpCode::NEQ_INT:
+            return os << "NEQ_INT";
+        case OpCode::ADD_FLT:
+            return os << "ADD_FLT";
+        case OpCode::SUB_FLT:
+            return os << "SUB_FLT";
+        case OpCode::MULT_FLT:
+            return os << "MULT_FLT";
+        case OpCode::LT_FLT:
+            return os << "LT_FLT";
+        case OpCode::LTE_FLT:
+            return os << "LTE_FLT";
+        case OpCode::GT_FLT:
+            return os << "GT_FLT";
+        case OpCode::GTE_FLT:
+            return os << "GTE_FLT";
+        case OpCode::EQ_FLT:
+            return os << "EQ_FLT";
+        case OpCode::NEQ_FLT:
+            return os << "NEQ_FLT";
+        case OpCode::JUMP:
+            return os << "JUMP";
+        case OpCode::JUMP_IF_FALSE:
+            return os << "JUMP_IF_FALSE";
+        case OpCode::CALL:
+            return os << "CALL";
+        case OpCode::TAIL_CALL:
+            return os << "TAIL_CALL";
+        case OpCode::BIND:
+            return os << "BIND";
+        case OpCode::EXPECT_FUNC:
+            return os << "EXPECT_FUNC";
+        case OpCode::RET:
+            return os << "RET";
+        case OpCode::RET_DEFAULT:
+            return os << "RET_DEFAULT";
+        case OpCode::THROW:
+            return os << "THROW";
+    }
+    return os << "UNKNOWN";
+}
+
+auto operator<<(std::ostream& os, const Chunk& chunk) -> std::ostream& {
+    os << "chunk " << chunk.name << " (params: " << chunk.params << ", locals: " << chunk.locals
+       << ", registers: " << chunk.registers << ")\n";
+    for (size_t i = 0; i < chunk.code.size(); ++i) {
+        const Instruction& instr = chunk.code[i];
+        os << std::setw(5) << i << "  " << std::left << std::setw(14) << instr.op << std::right
+           << instr.a << ", " << instr.b << ", " << instr.c << "    ; " << chunk.positions[i]
+           << '\n';
+    }
+    return os;
+}
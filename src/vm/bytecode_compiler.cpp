@@ -0,0 +1,370 @@
+#include "bytecode_compiler.h"
+
+#include <algorithm>
+#include <ranges>
+
+#include "block.h"
+#include "exceptions.h"
+#include "overload.h"
+#include "statement_specific.h"
+
+/**
+ * @brief translate a binary operator into the instruction implementing it
+ */
+static auto binary_opcode(BinaryOp op) -> OpCode {
+    switch (op) {
+        case BinaryOp::ADD:
+            return OpCode::ADD;
+        case BinaryOp::SUB:
+            return OpCode::SUB;
+        case BinaryOp::MULT:
+            return OpCode::MULT;
+        case BinaryOp::DIV:
+            return OpCode::DIV;
+        case BinaryOp::LT:
+            return OpCode::LT;
+        case BinaryOp::LTE:
+            return OpCode::LTE;
+        case BinaryOp::GT:
+            return OpCode::GT;
+        case BinaryOp::GTE:
+            return OpCode::GTE;
+        case BinaryOp::EQ:
+            return OpCode::EQ;
+        case BinaryOp::NEQ:
+            return OpCode::NEQ;
+        case BinaryOp::AND:
+            return OpCode::AND;
+        case BinaryOp::OR:
+            return OpCode::OR;
+        case BinaryOp::DECORATE:
+            return OpCode::DECORATE;
+    }
+    throw InterpreterError("Unsupported operator");
+}
+
+/**
+ * @brief pick the monomorphic variant of an instruction for operands of a known numeric type
+ */
+static auto typed_opcode(OpCode op, std::optional<BaseType> type) -> OpCode {
+    if (type != BaseType::INT && type != BaseType::FLT) return op;
+    const bool is_int = type == BaseType::INT;
+    switch (op) {
+        case OpCode::ADD:
+            return is_int ? OpCode::ADD_INT : OpCode::ADD_FLT;
+        case OpCode::SUB:
+            return is_int ? OpCode::SUB_INT : OpCode::SUB_FLT;
+        case OpCode::MULT:
+            return is_int ? OpCode::MULT_INT : OpCode::MULT_FLT;
+        case OpCode::LT:
+            return is_int ? OpCode::LT_INT : OpCode::LT_FLT;
+        case OpCode::LTE:
+            return is_int ? OpCode::LTE_INT : OpCode::LTE_FLT;
+        case OpCode::GT:
+            return is_int ? OpCode::GT_INT : OpCode::GT_FLT;
+        case OpCode::GTE:
+            return is_int ? OpCode::GTE_INT : OpCode::GTE_FLT;
+        case OpCode::EQ:
+            return is_int ? OpCode::EQ_INT : OpCode::EQ_FLT;
+        case OpCode::NEQ:
+            return is_int ? OpCode::NEQ_INT : OpCode::NEQ_FLT;
+        default:
+            return op;
+    }
+}
+
+BytecodeCompiler::BytecodeCompiler(FunctionLookup find_func) : find_func(std::move(find_func)) {}
+
+auto BytecodeCompiler::compile(const Function& func) -> std::unique_ptr<Chunk> {
+    chunk = std::make_unique<Chunk>();
+    scopes.clear();
+    next_reg = 0;
+    result = 0;
+    position = func.get_position();
+    func.accept(*this);
+    return std::move(chunk);
+}
+
+auto BytecodeCompiler::emit(OpCode op, uint32_t a, uint32_t b, uint32_t c) -> uint32_t {
+    chunk->code.push_back({op, a, b, c});
+    chunk->positions.push_back(position);
+    return static_cast<uint32_t>(chunk->code.size() - 1);
+}
+
+auto BytecodeCompiler::add_constant(ValType value) -> uint32_t {
+    chunk->constants.push_back(std::move(value));
+    return static_cast<uint32_t>(chunk->constants.size() - 1);
+}
+
+auto BytecodeCompiler::alloc_reg() -> uint32_t {
+    chunk->registers = std::max(chunk->registers, next_reg + 1);
+    return next_reg++;
+}
+
+void BytecodeCompiler::patch_jump(uint32_t jump) {
+    auto& instr = chunk->code[jump];
+    const auto target = static_cast<uint32_t>(chunk->code.size());
+    if (instr.op == OpCode::JUMP) {
+        instr.a = target;
+    } else {
+        instr.b = target;
+    }
+}
+
+void BytecodeCompiler::emit_throw(const std::string& message) {
+    emit(OpCode::THROW, add_constant(message));
+}
+
+auto BytecodeCompiler::find_local(Symbol name) const -> const LocalVar* {
+    for (const auto& scope : std::ranges::reverse_view(scopes)) {
+        auto var = std::ranges::find_if(std::ranges::reverse_view(scope),
+                                        [&name](const LocalVar& var) { return var.name == name; });
+        if (var != std::ranges::reverse_view(scope).end()) return &*var;
+    }
+    return nullptr;
+}
+
+auto BytecodeCompiler::compile_expr(const Expression* expr) -> uint32_t {
+    expr->accept(*this);
+    return result;
+}
+
+void BytecodeCompiler::visit(const Function& func) {
+    const auto* signature = func.get_signature();
+    chunk->name = signature->get_name();
+    chunk->ret_default = default_value(*signature->get_type()->get_ret_type());
+    chunk->ret_type = signature->get_type();
+
+    // parameters occupy the first local slots, in order
+    auto& params = scopes.emplace_back();
+    for (const auto* param : signature->get_params()) {
+        params.push_back({param->get_symbol(), chunk->params++, param});
+    }
+    chunk->locals = chunk->params;
+
+    func.get_body()->accept(*this);
+    emit(OpCode::RET_DEFAULT);
+}
+
+void BytecodeCompiler::visit(const Block& block) {
+    scopes.emplace_back();
+    for (const auto* stmt : block.get_statements()) {
+        // temporaries do not outlive the statement that created them
+        const uint32_t mark = next_reg;
+        track(stmt);
+        next_reg = mark;
+    }
+    scopes.pop_back();
+}
+
+void BytecodeCompiler::visit(const LiteralExpr& expr) { load_literal(expr.get_value()); }
+
+void BytecodeCompiler::load_literal(const ValueType& value) {
+    result = alloc_reg();
+    emit(OpCode::LOAD_CONST, result, add_constant(literal_value(value)));
+}
+
+void BytecodeCompiler::visit(const IdentifierExpr& expr) {
+    const Symbol name = expr.get_symbol();
+    result = alloc_reg();
+
+    if (const auto* local = find_local(name)) {
+        emit(OpCode::LOAD_LOCAL, result, local->slot);
+    } else if (auto func = find_func(name)) {
+        emit(OpCode::LOAD_CONST, result, add_constant(std::move(func)));
+    } else {
+        emit_throw("Unknown identifier");
+    }
+}
+
+void BytecodeCompiler::visit(const UnaryExpr& expr) {
+    if (const auto& folded = expr.get_folded()) {
+        load_literal(*folded);
+        return;
+    }
+    const uint32_t right = compile_expr(expr.get_right());
+    const OpCode op = expr.get_operator() == UnaryOp::NOT ? OpCode::NOT : OpCode::NEG;
+    emit(op, right, right);
+    result = right;
+    next_reg = right + 1;
+}
+
+void BytecodeCompiler::visit(const BinaryExpr& expr) {
+    if (const auto& folded = expr.get_folded()) {
+        load_literal(*folded);
+        return;
+    }
+    // the right operand is evaluated first
+    const uint32_t right = compile_expr(expr.get_right());
+    const uint32_t left = compile_expr(expr.get_left());
+    const OpCode op = binary_opcode(expr.get_operator());
+    emit(typed_opcode(op, expr.get_operand_type()), right, left, right);
+    result = right;
+    next_reg = right + 1;
+}
+
+void BytecodeCompiler::visit(const CallExpr& expr) {
+    track(expr.get_func_name());
+    const uint32_t callee = result;
+
+    CallSite site;
+    for (const auto* arg : expr.get_args()) {
+        // local variables are passed by reference, everything else by value
+        const auto* identifier = dynamic_cast<const IdentifierExpr*>(arg);
+        if (const auto* local = identifier ? find_local(identifier->get_symbol()) : nullptr) {
+            site.args.push_back({true, local->slot});
+        } else {
+            track(arg);
+            site.args.push_back({false, result});
+        }
+    }
+    chunk->call_sites.push_back(std::move(site));
+
+    emit(OpCode::CALL, callee, callee, static_cast<uint32_t>(chunk->call_sites.size() - 1));
+    result = callee;
+    next_reg = callee + 1;
+}
+
+void BytecodeCompiler::visit(const BindFrtExpr& expr) {
+    track(expr.get_func_name());
+    const uint32_t callee = result;
+    emit(OpCode::EXPECT_FUNC, callee, add_constant("Expected valid function identifier"));
+
+    // bind front always binds values
+    CallSite site;
+    for (const auto* arg : expr.get_args()) {
+        track(arg);
+        site.args.push_back({false, result});
+    }
+    chunk->call_sites.push_back(std::move(site));
+
+    emit(OpCode::BIND, callee, callee, static_cast<uint32_t>(chunk->call_sites.size() - 1));
+    result = callee;
+    next_reg = callee + 1;
+}
+
+void BytecodeCompiler::visit(const AssignStatement& stmt) {
+    track(stmt.get_value());
+    const uint32_t value = result;
+    const Symbol identifier = stmt.get_symbol();
+    const auto* local = find_local(identifier);
+
+    if (!stmt.get_type()) {
+        if (!local) {
+            emit_throw("Variable not in scope: " + identifier.str());
+        } else if (!local->signature->get_type()->get_mut()) {
+            emit_throw("Immutable variables cannot be reassigned");
+        } else {
+            emit(OpCode::STORE, local->slot, value);
+        }
+        return;
+    }
+
+    if (local) {
+        emit_throw("Variable " + identifier.str() + " is already defined in this frame");
+        return;
+    }
+
+    const auto* signature = stmt.get_signature();
+    chunk->declarations.push_back({signature, default_value(*signature->get_type())});
+
+    uint32_t slot = 0;
+    for (const auto& scope : scopes) slot += static_cast<uint32_t>(scope.size());
+    scopes.back().push_back({identifier, slot, signature});
+    chunk->locals = std::max(chunk->locals, slot + 1);
+
+    emit(OpCode::DECLARE, slot, static_cast<uint32_t>(chunk->declarations.size() - 1), value);
+}
+
+void BytecodeCompiler::visit(const WhileLoopStatement& stmt) {
+    const auto loop_start = static_cast<uint32_t>(chunk->code.size());
+
+    const uint32_t mark = next_reg;
+    const uint32_t condition = compile_expr(stmt.get_condition());
+    const uint32_t exit_jump = emit(OpCode::JUMP_IF_FALSE, condition);
+    next_reg = mark;
+
+    track(stmt.get_body());
+    emit(OpCode::JUMP, loop_start);
+    patch_jump(exit_jump);
+}
+
+void BytecodeCompiler::visit(const ConditionalStatement& stmt) {
+    const uint32_t mark = next_reg;
+    const uint32_t condition = compile_expr(stmt.get_condition());
+    const uint32_t else_jump = emit(OpCode::JUMP_IF_FALSE, condition);
+    next_reg = mark;
+
+    track(stmt.get_body());
+
+    if (const auto* else_st = stmt.get_else_st()) {
+        const uint32_t end_jump = emit(OpCode::JUMP);
+        patch_jump(else_jump);
+        track(else_st);
+        patch_jump(end_jump);
+    } else {
+        patch_jump(else_jump);
+    }
+}
+
+void BytecodeCompiler::visit(const ElseStatement& stmt) { track(stmt.get_body()); }
+
+void BytecodeCompiler::visit(const ForLoopStatement& stmt) {
+    const auto& args = *stmt.get_args();
+
+    // the iterator lives in the enclosing scope
+    const LocalVar* iterator = std::visit(
+        Overload{[this](const std::unique_ptr<Statement>& iterator) -> const LocalVar* {
+                     iterator->accept(*this);
+                     if (scopes.back().empty()) return nullptr;
+                     return &scopes.back().back();
+                 },
+                 [this](Symbol iterator) { return find_local(iterator); }},
+        args.iterator);
+
+    if (!iterator) {
+        emit_throw("Invalid iterator");
+        return;
+    }
+    const uint32_t iterator_slot = iterator->slot;
+
+    track(stmt.get_on_iter());
+    const uint32_t on_iter = result;
+    emit(OpCode::EXPECT_FUNC, on_iter, add_constant("on iter call must be a function"));
+
+    chunk->call_sites.push_back({{{true, iterator_slot}}});
+    const auto on_iter_site = static_cast<uint32_t>(chunk->call_sites.size() - 1);
+
+    const auto loop_start = static_cast<uint32_t>(chunk->code.size());
+    const uint32_t mark = next_reg;
+    const uint32_t condition = compile_expr(args.condition.get());
+    const uint32_t exit_jump = emit(OpCode::JUMP_IF_FALSE, condition);
+    next_reg = mark;
+
+    track(stmt.get_body());
+
+    // keep the on iter function in its register, the call's result goes to a scratch one
+    const uint32_t call_reg = alloc_reg();
+    emit(OpCode::CALL, call_reg, on_iter, on_iter_site);
+    next_reg = mark;
+
+    emit(OpCode::JUMP, loop_start);
+    patch_jump(exit_jump);
+}
+
+void BytecodeCompiler::visit(const RetStatement& stmt) {
+    const auto* retval = stmt.get_retval();
+    if (!retval) {
+        emit(OpCode::RET_DEFAULT);
+        return;
+    }
+    track(retval);
+    // a returned call is compiled into a `CALL`, which may run in place of this function
+    if (dynamic_cast<const CallExpr*>(retval)) {
+        chunk->code.back().op = OpCode::TAIL_CALL;
+        return;
+    }
+    emit(OpCode::RET, result);
+}
+
+void BytecodeCompiler::visit(const CallStatement& stmt) { track(stmt.get_call()); }
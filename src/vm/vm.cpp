@@ -0,0 +1,505 @@
+#include "vm.h"
+
+#include <iostream>
+
+#include "arithmetics.h"
+#include "bytecode_compiler.h"
+#include "interpreter_shall.h"
+#include "overload.h"
+#include "resolver.h"
+#include "type_cast.h"
+
+/**
+ * Computed goto dispatch is a GNU extension, other compilers fall back to a switch
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define TKOM_COMPUTED_GOTO
+#endif
+
+#ifdef TKOM_COMPUTED_GOTO
+#define VM_CASE(op) op_##op
+#define VM_DISPATCH() goto *dispatch_table[static_cast<uint8_t>(ip->op)]
+#else
+#define VM_CASE(op) case OpCode::op
+#define VM_DISPATCH() goto dispatch
+#endif
+
+#define VM_NEXT()       \
+    do {                \
+        ++ip;           \
+        VM_DISPATCH();  \
+    } while (0)
+
+/**
+ * Monomorphic binary operators, the resolver proved both operands to be of the given type
+ */
+#define VM_TYPED_BINARY(op, type, operator)                                         \
+    VM_CASE(op) : {                                                                 \
+        const type left = *std::get_if<type>(&reg[ip->b]);                          \
+        const type right = *std::get_if<type>(&reg[ip->c]);                         \
+        reg[ip->a] = left operator right;                                           \
+        VM_NEXT();                                                                  \
+    }
+
+static const ValType bool_type{true};
+
+/**
+ * @brief gather the arguments of a call site from the current frame into `args`
+ *
+ * Room is left for `bound` more arguments, bound in front of these by the callee.
+ */
+static void collect_args(const CallSite& site, ValType* reg, Variable** local, ArgVector& args,
+                         size_t bound = 0) {
+    args.clear();
+    args.reserve(site.args.size() + bound);
+    for (const auto& arg : site.args) {
+        if (arg.by_ref) {
+            args.emplace_back(local[arg.index]);
+        } else {
+            args.emplace_back(reg[arg.index]);
+        }
+    }
+}
+
+/**
+ * @brief extract a function from a register
+ */
+static auto as_callable(const ValType& value) -> std::shared_ptr<Callable> {
+    shall(std::holds_alternative<std::shared_ptr<Callable>>(value),
+          "Expected valid function identifier");
+    return std::get<std::shared_ptr<Callable>>(value);
+}
+
+VirtualMachine::VirtualMachine(std::vector<std::shared_ptr<Callable>> builtins, bool verbose)
+    : functions(builtins), verbose(verbose) {}
+
+void VirtualMachine::set_max_depth(size_t depth) {
+    max_depth = depth;
+}
+
+void VirtualMachine::run(const Program& program) {
+    for (const auto& fn : program.get_functions()) {
+        try {
+            register_function(fn);
+        } catch (InterpreterError& e) {
+            throw GeneralError(fn->get_position(), e.what());
+        }
+    }
+
+    Resolver resolver(&functions);
+    program.accept(resolver);
+
+    auto main = find_func("main");
+    ArgVector main_args;
+    main->call(*this, main_args);
+}
+
+void VirtualMachine::run(ProgramStream& stream) {
+    functions.stream_from(&stream);
+
+    auto main = find_func("main");
+    shall(main, "Missing main function");
+    ArgVector main_args;
+    main->call(*this, main_args);
+
+    functions.load_all();
+}
+
+void VirtualMachine::register_function(const Function* func) {
+    shall(functions.add(std::make_shared<GlobalFunction>(func)),
+          [func] { return "Attempted to re-define " + func->get_signature()->get_name(); });
+}
+
+void VirtualMachine::resolve(const Function& func) {
+    Resolver resolver(&functions);
+    func.accept(resolver);
+}
+
+auto VirtualMachine::find_func(const std::string& name) -> std::shared_ptr<Callable> {
+    return functions.load(Symbol(name));
+}
+
+auto VirtualMachine::get_value() const -> ValType { return current_value; }
+
+void VirtualMachine::override_value(ValType val) { current_value = std::move(val); }
+
+auto VirtualMachine::init_var(const Type& type) -> ValType { return default_value(type); }
+
+auto VirtualMachine::get_chunk(const Function& func) -> const Chunk& {
+    auto& chunk = chunks[&func];
+    if (!chunk) {
+        BytecodeCompiler compiler([this](Symbol name) { return functions.load(name); });
+        chunk = compiler.compile(func);
+        if (verbose) std::cout << *chunk;
+    }
+    return *chunk;
+}
+
+void VirtualMachine::bind_args(const Function& func, ArgVector& args, Variable** local,
+                               Variable* storage) {
+    // references are bound directly, values are stored in the frame
+    const auto params = func.get_signature()->get_params();
+    for (size_t i = 0; i < args.size(); ++i) {
+        local[i] = std::visit(Overload{[](Variable* var) { return var; },
+                                       [&](ValType& value) {
+                                           storage[i] = Variable{params[i], std::move(value)};
+                                           return &storage[i];
+                                       }},
+                              args[i]);
+    }
+}
+
+void VirtualMachine::run_function(const Function& func, ArgVector& args) {
+    if (depth >= max_depth) throw call_depth_error(max_depth);
+    const Chunk& chunk = get_chunk(func);
+
+    const size_t reg_base = registers.size();
+    const size_t local_base = locals.size();
+    const size_t value_base = values.size();
+    Variable* storage = values.grow(chunk.locals);
+    registers.resize(reg_base + chunk.registers);
+    locals.resize(local_base + chunk.locals);
+
+    // release the frame even if the function throws
+    struct FrameGuard {
+        VirtualMachine& vm;
+        size_t reg_base;
+        size_t local_base;
+        size_t value_base;
+        ~FrameGuard() {
+            vm.registers.resize(reg_base);
+            vm.locals.resize(local_base);
+            vm.values.truncate(value_base);
+            --vm.depth;
+        }
+    } guard{*this, reg_base, local_base, value_base};
+    ++depth;
+
+    bind_args(func, args, locals.data() + local_base, storage);
+    execute(chunk, reg_base, local_base, value_base);
+}
+
+#ifdef TKOM_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+void VirtualMachine::execute(const Chunk& entry, size_t reg_base, size_t local_base,
+                             size_t value_base) {
+    const Chunk* chunk = &entry;
+    const Instruction* code = chunk->code.data();
+    const Instruction* ip = code;
+    ValType* reg = registers.data() + reg_base;
+    Variable** local = locals.data() + local_base;
+    // variables on the value stack never move
+    Variable* storage = &values[value_base];
+
+    // the last tail call made in the frame, whose returned value still has to be cast
+    GlobalFunction* tail_target = nullptr;
+    Position tail_site;
+
+    // frames pushed by this call are dropped when an error unwinds it, along with the stacks
+    // released by run_function
+    struct FrameGuard {
+        VirtualMachine& vm;
+        size_t frames;
+        size_t depth;
+        ~FrameGuard() {
+            vm.frames.resize(frames);
+            vm.depth = depth;
+        }
+    } guard{*this, frames.size(), depth};
+    auto finish_tail_call = [&] {
+        if (!tail_target) return;
+        try {
+            tail_target->finish_call(*this);
+        } catch (InterpreterError& e) {
+            throw GeneralError(tail_site, e.what());
+        }
+    };
+
+    // run a user-defined function in a new frame, returning to the call instruction at `ip`
+    auto push_frame = [&](GlobalFunction* target, ArgVector& args) {
+        if (depth >= max_depth) throw call_depth_error(max_depth);
+        const Function& func = *target->get_func();
+        const Chunk& next = get_chunk(func);
+
+        // the callee's frame starts right above the caller's
+        const size_t next_value_base = values.size();
+        Variable* next_storage = values.grow(next.locals);
+        frames.emplace_back(chunk, ip, reg_base, local_base, value_base, storage, target,
+                            tail_target, tail_site);
+        ++depth;
+        reg_base = registers.size();
+        local_base = locals.size();
+        value_base = next_value_base;
+        registers.resize(reg_base + next.registers);
+        locals.resize(local_base + next.locals);
+
+        tail_target = nullptr;
+        chunk = &next;
+        code = chunk->code.data();
+        ip = code;
+        reg = registers.data() + reg_base;
+        local = locals.data() + local_base;
+        storage = next_storage;
+        bind_args(func, args, local, storage);
+    };
+
+#ifdef TKOM_COMPUTED_GOTO
+    // must follow the order of OpCode
+    static const void* const dispatch_table[] = {
+        &&op_LOAD_CONST, &&op_LOAD_LOCAL, &&op_DECLARE,       &&op_STORE,   &&op_ADD,
+        &&op_SUB,        &&op_MULT,       &&op_DIV,           &&op_LT,      &&op_LTE,
+        &&op_GT,         &&op_GTE,        &&op_EQ,            &&op_NEQ,     &&op_AND,
+        &&op_OR,         &&op_DECORATE,   &&op_NOT,           &&op_NEG,     &&op_ADD_INT,
+        &&op_SUB_INT,    &&op_MULT_INT,   &&op_LT_INT,        &&op_LTE_INT, &&op_GT_INT,
+        &&op_GTE_INT,    &&op_EQ_INT,     &&op_NEQ_INT,       &&op_ADD_FLT, &&op_SUB_FLT,
+        &&op_MULT_FLT,   &&op_LT_FLT,     &&op_LTE_FLT,       &&op_GT_FLT,  &&op_GTE_FLT,
+        &&op_EQ_FLT,     &&op_NEQ_FLT,    &&op_JUMP,          &&op_JUMP_IF_FALSE, &&op_CALL,
+        &&op_TAIL_CALL,  &&op_BIND,       &&op_EXPECT_FUNC,   &&op_RET,     &&op_RET_DEFAULT,
+        &&op_THROW,
+    };
+#endif
+
+    try {
+#ifdef TKOM_COMPUTED_GOTO
+        VM_DISPATCH();
+        {
+#else
+    dispatch:
+        switch (ip->op) {
+#endif
+            VM_CASE(LOAD_CONST) : {
+                reg[ip->a] = chunk->constants[ip->b];
+                VM_NEXT();
+            }
+            VM_CASE(LOAD_LOCAL) : {
+                reg[ip->a] = local[ip->b]->value;
+                VM_NEXT();
+            }
+            VM_CASE(DECLARE) : {
+                const Declaration& decl = chunk->declarations[ip->b];
+                storage[ip->a] =
+                    Variable{decl.signature, std::visit(TypeCast(), reg[ip->c], decl.init)};
+                local[ip->a] = &storage[ip->a];
+                VM_NEXT();
+            }
+            VM_CASE(STORE) : {
+                auto& var = *local[ip->a];
+                var.value = std::visit(TypeCast(), reg[ip->b], var.value);
+                VM_NEXT();
+            }
+            VM_CASE(ADD) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::ADD, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(SUB) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::SUB, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(MULT) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::MULT, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(DIV) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::DIV, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(LT) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::LT, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(LTE) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::LTE, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(GT) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::GT, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(GTE) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::GTE, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(EQ) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::EQ, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(NEQ) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::NEQ, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(AND) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::AND, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(OR) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::OR, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(DECORATE) : {
+                reg[ip->a] = apply_binary_op(BinaryOp::DECORATE, reg[ip->b], reg[ip->c]);
+                VM_NEXT();
+            }
+            VM_CASE(NOT) : {
+                reg[ip->a] = apply_unary_op(UnaryOp::NOT, reg[ip->b]);
+                VM_NEXT();
+            }
+            VM_CASE(NEG) : {
+                reg[ip->a] = apply_unary_op(UnaryOp::MINUS, reg[ip->b]);
+                VM_NEXT();
+            }
+            VM_TYPED_BINARY(ADD_INT, int, +)
+            VM_TYPED_BINARY(SUB_INT, int, -)
+            VM_TYPED_BINARY(MULT_INT, int, *)
+            VM_TYPED_BINARY(LT_INT, int, <)
+            VM_TYPED_BINARY(LTE_INT, int, <=)
+            VM_TYPED_BINARY(GT_INT, int, >)
+            VM_TYPED_BINARY(GTE_INT, int, >=)
+            VM_TYPED_BINARY(EQ_INT, int, ==)
+            VM_TYPED_BINARY(NEQ_INT, int, !=)
+            VM_TYPED_BINARY(ADD_FLT, double, +)
+            VM_TYPED_BINARY(SUB_FLT, double, -)
+            VM_TYPED_BINARY(MULT_FLT, double, *)
+            VM_TYPED_BINARY(LT_FLT, double, <)
+            VM_TYPED_BINARY(LTE_FLT, double, <=)
+            VM_TYPED_BINARY(GT_FLT, double, >)
+            VM_TYPED_BINARY(GTE_FLT, double, >=)
+            VM_TYPED_BINARY(EQ_FLT, double, ==)
+            VM_TYPED_BINARY(NEQ_FLT, double, !=)
+            VM_CASE(JUMP) : {
+                ip = code + ip->a;
+                VM_DISPATCH();
+            }
+            VM_CASE(JUMP_IF_FALSE) : {
+                if (std::get<bool>(std::visit(TypeCast(), reg[ip->a], bool_type))) {
+                    VM_NEXT();
+                }
+                ip = code + ip->b;
+                VM_DISPATCH();
+            }
+            VM_CASE(CALL) : {
+                auto callee = as_callable(reg[ip->b]);
+                // builtins never call back into the machine, so the arguments are bound before
+                // the next call collects its own
+                ArgVector& args = call_args;
+                collect_args(chunk->call_sites[ip->c], reg, local, args, callee->bound_count());
+
+                GlobalFunction* target = callee->get_target(args);
+                if (!target) {
+                    callee->call(*this, args);
+                    // the callee's frame may have reallocated the stacks
+                    reg = registers.data() + reg_base;
+                    local = locals.data() + local_base;
+                    reg[ip->a] = current_value;
+                    VM_NEXT();
+                }
+                target->prepare_call(*this, args);
+                push_frame(target, args);
+                VM_DISPATCH();
+            }
+            VM_CASE(TAIL_CALL) : {
+                auto callee = as_callable(reg[ip->b]);
+                ArgVector& args = call_args;
+                collect_args(chunk->call_sites[ip->c], reg, local, args, callee->bound_count());
+
+                GlobalFunction* target = callee->get_target(args);
+                if (!target) {
+                    // the builtin's value is returned as it is
+                    callee->call(*this, args);
+                    goto leave_frame;
+                }
+                // arguments are checked while the variables they refer to are still in scope
+                target->prepare_call(*this, args);
+                if (!target->can_replace(chunk->ret_type)) {
+                    // called as usual, the frame returns the value once the callee cast it
+                    push_frame(target, args);
+                    VM_DISPATCH();
+                }
+                const Function& func = *target->get_func();
+                const Chunk& next = get_chunk(func);
+
+                // release the frame, keeping the variables passed on by reference below the
+                // storage of the new function
+                registers.resize(reg_base);
+                registers.resize(reg_base + next.registers);
+                locals.resize(local_base);
+                locals.resize(local_base + next.locals);
+                values.truncate_keeping(value_base, args);
+                Variable* next_storage = values.grow(next.locals);
+
+                tail_target = target;
+                tail_site = chunk->positions[ip - code];
+                chunk = &next;
+                code = chunk->code.data();
+                ip = code;
+                reg = registers.data() + reg_base;
+                local = locals.data() + local_base;
+                storage = next_storage;
+                bind_args(func, args, local, storage);
+                VM_DISPATCH();
+            }
+            VM_CASE(BIND) : {
+                auto callee = as_callable(reg[ip->b]);
+                ArgVector bound;
+                collect_args(chunk->call_sites[ip->c], reg, local, bound);
+                reg[ip->a] = std::make_shared<LocalFunction>(callee, std::move(bound));
+                VM_NEXT();
+            }
+            VM_CASE(EXPECT_FUNC) : {
+                shall(std::holds_alternative<std::shared_ptr<Callable>>(reg[ip->a]),
+                      [&] { return std::get<std::string>(chunk->constants[ip->b]); });
+                VM_NEXT();
+            }
+            VM_CASE(RET) : {
+                current_value = reg[ip->a];
+                goto leave_frame;
+            }
+            VM_CASE(RET_DEFAULT) : {
+                current_value = chunk->ret_default;
+                goto leave_frame;
+            }
+            VM_CASE(THROW) : {
+                throw InterpreterError(std::get<std::string>(chunk->constants[ip->a]));
+            }
+        }
+
+    leave_frame:
+        finish_tail_call();
+        if (frames.size() == guard.frames) return;
+        {
+            registers.resize(reg_base);
+            locals.resize(local_base);
+            values.truncate(value_base);
+            --depth;
+
+            const Frame& caller = frames.back();
+            const GlobalFunction* callee = caller.callee;
+            chunk = caller.chunk;
+            code = chunk->code.data();
+            ip = caller.ip;
+            reg_base = caller.reg_base;
+            local_base = caller.local_base;
+            value_base = caller.value_base;
+            storage = caller.storage;
+            tail_target = caller.tail_target;
+            tail_site = caller.tail_site;
+            frames.pop_back();
+            reg = registers.data() + reg_base;
+            local = locals.data() + local_base;
+
+            // cast the returned value at the call site, as a nested call would
+            callee->finish_call(*this);
+            if (ip->op == OpCode::TAIL_CALL) goto leave_frame;
+            reg[ip->a] = current_value;
+            VM_NEXT();
+        }
+    } catch (InterpreterError& e) {
+        throw GeneralError(chunk->positions[ip - code], e.what());
+    }
+}
+
+#ifdef TKOM_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
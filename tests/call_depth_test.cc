@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "engine_test_runner.h"
+
+std::string recursion(int n) {
+    return "int main { (" + std::to_string(n) + ") -> sum => int s; ret s; }\n"
+           "int sum :: int n { if (n <= 0) { ret 0; } ret ((n - 1) -> sum) + n; }";
+}
+
+TEST(CallDepthTest, NestsCallsWithoutNativeRecursion) {
+    // far deeper than the native stack would allow a recursive engine to go
+    auto result = run<VirtualMachine>(recursion(60000));
+    EXPECT_EQ(result.error, "");
+    EXPECT_EQ(result.value, ValType{1800030000});
+}
+
+TEST(CallDepthTest, ReportsExceededLimit) {
+    // main and the calls for 99..0
+    EXPECT_EQ(run<InterpreterVisitor>(recursion(99), 101).value, ValType{4950});
+    EXPECT_EQ(run<VirtualMachine>(recursion(99), 101).value, ValType{4950});
+
+    const std::string error =
+        "\x1b[1;31mException thrown at 2:56\x1b[0m - Stack overflow, exceeded the maximum depth "
+        "of 100 nested calls";
+    EXPECT_EQ(run<InterpreterVisitor>(recursion(99), 100).error, error);
+    EXPECT_EQ(run<VirtualMachine>(recursion(99), 100).error, error);
+}
+
+TEST(CallDepthTest, TailCallsDoNotNest) {
+    const std::string source =
+        "int main { ret (10000, 0) -> count; }"
+        "int count :: int n, int acc { if (n == 0) { ret acc; } ret (n - 1, acc + 1) -> count; }";
+    EXPECT_EQ(run<InterpreterVisitor>(source, 10).value, ValType{10000});
+    EXPECT_EQ(run<VirtualMachine>(source, 10).value, ValType{10000});
+}
+
+TEST(CallDepthTest, MixedTailCallsNest) {
+    // calls that cast the value to another type cannot be replaced, so they count as nested
+    const std::string source =
+        "int main { ret (200000) -> f; }\n"
+        "int f :: int n { if (n == 0) { ret 0; } ret (n - 1) -> g; }\n"
+        "flt g :: int n { ret (n) -> f; }";
+    const std::string error =
+        "\x1b[1;31mException thrown at 3:26\x1b[0m - Stack overflow, exceeded the maximum depth "
+        "of 65536 nested calls";
+    EXPECT_EQ(run<VirtualMachine>(source).error, error);
+
+    auto expected = run<InterpreterVisitor>(source, 100);
+    EXPECT_NE(expected.error, "");
+    EXPECT_EQ(run<VirtualMachine>(source, 100).error, expected.error);
+}
+
+TEST(CallDepthTest, ValueStackGrowsInChunks) {
+    ValueStack values;
+    values.grow(ValueStack::chunk_size - 2);
+    Variable* below = values.push(Variable{nullptr, 1});
+
+    // a frame that does not fit the rest of a chunk starts the next one, leaving the others put
+    Variable* frame = values.grow(2);
+    EXPECT_EQ(&values[ValueStack::chunk_size - 2], below);
+    EXPECT_EQ(&values[ValueStack::chunk_size - 1], frame);
+    EXPECT_EQ(values.size(), ValueStack::chunk_size + 1);
+
+    // variables passed on to a tail call move down, into the chunk below
+    frame[1].value = 2;
+    ArgVector args{&frame[1]};
+    values.truncate_keeping(ValueStack::chunk_size - 2, args);
+    EXPECT_EQ(values.size(), ValueStack::chunk_size - 1);
+    EXPECT_EQ(std::get<Variable*>(args[0]), below);
+    EXPECT_EQ(below->value, ValType{2});
+
+    values.truncate(0);
+    EXPECT_EQ(values.size(), 0);
+}
+
+struct DepthProgram {
+    std::string program;
+};
+
+class CallDepthParityTest : public ::testing::TestWithParam<DepthProgram> {};
+
+TEST_P(CallDepthParityTest, MatchesInterpreter) {
+    const auto& param = GetParam();
+    std::cout << "TESTING: " << param.program << std::endl;
+
+    auto expected = run<InterpreterVisitor>(param.program);
+    auto actual = run<VirtualMachine>(param.program);
+    EXPECT_EQ(actual.value, expected.value);
+    EXPECT_EQ(actual.output, expected.output);
+    EXPECT_EQ(actual.error, expected.error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DepthPrograms,
+    CallDepthParityTest,
+    ::testing::Values(
+        // errors deep in the recursion, and in the cast of a returned value
+        DepthProgram{"int main { ret (50) -> r; }\n"
+                     "int r :: int n { if (n == 0) { ret (1, 2) -> r; } ret ((n - 1) -> r) + 1; }"},
+        DepthProgram{"int main { ret (50) -> r; }\n"
+                     "int r :: int n { if (n == 0) { ret (\"x\") -> s; } ret ((n - 1) -> r) + 1; }\n"
+                     "string s :: string a { ret a; }"},
+        // values cast on the way back up
+        DepthProgram{"int main { ret (20) -> r; }\n"
+                     "int r :: int n { if (n == 0) { ret 0; } ret ((n - 1) -> half) + 1; }\n"
+                     "flt half :: int n { ret ((n) -> r) / 2.0; }"},
+        // references to variables of waiting callers
+        DepthProgram{"int main { 0 => mut int total; (30, total) -> r; ret total; }\n"
+                     "void r :: int n, mut int total { if (n > 0) { total + n => total; (n - 1, total) -> r; } }"},
+        // calls through bound, decorated and builtin functions
+        DepthProgram{"int main { (3) ->> add => [int::int] add_3; add_3 @ twice => [int::int] add_6;"
+                     "    ret (10, add_6) -> apply; }\n"
+                     "int add :: int a, int b { ret a + b; }\n"
+                     "int twice :: [int::int] func, int a { ret ((a) -> func) -> func; }\n"
+                     "int apply :: int n, [int::int] f { if (n == 0) { ret 0; } (\"*\") -> stdout;"
+                     "    ret ((n - 1, f) -> apply) + (n) -> f; }"}
+    )
+);
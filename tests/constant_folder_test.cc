@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "constant_folder.h"
+#include "engine_test_runner.h"
+
+TEST(ConstantFolderTest, FoldsLiteralExpressions) {
+    auto program = parse_program("int main { 0 => int a; ret a + 2 * 3; }");
+    ConstantFolder folder;
+    program->accept(folder);
+
+    auto statements = program->get_functions()[0]->get_body()->get_statements();
+    auto ret = dynamic_cast<const RetStatement*>(statements[1]);
+    auto sum = dynamic_cast<const BinaryExpr*>(ret->get_retval());
+    EXPECT_FALSE(sum->get_folded().has_value());
+
+    auto product = dynamic_cast<const BinaryExpr*>(sum->get_right());
+    ASSERT_TRUE(product->get_folded().has_value());
+    EXPECT_EQ(std::get<int>(*product->get_folded()), 6);
+}
+
+TEST(ConstantFolderTest, LeavesFailingExpressions) {
+    auto program = parse_program("int main { ret (\"a\" - 1) + 1 / 0; }");
+    ConstantFolder folder;
+    program->accept(folder);
+
+    auto statements = program->get_functions()[0]->get_body()->get_statements();
+    auto ret = dynamic_cast<const RetStatement*>(statements[0]);
+    auto sum = dynamic_cast<const BinaryExpr*>(ret->get_retval());
+    EXPECT_FALSE(sum->get_folded().has_value());
+    EXPECT_FALSE(dynamic_cast<const BinaryExpr*>(sum->get_left())->get_folded().has_value());
+    EXPECT_FALSE(dynamic_cast<const BinaryExpr*>(sum->get_right())->get_folded().has_value());
+}
+
+struct FoldedProgram {
+    std::string program;
+};
+
+class FoldedParityTest : public ::testing::TestWithParam<FoldedProgram> {};
+
+TEST_P(FoldedParityTest, MatchesUnfoldedProgram) {
+    const auto& param = GetParam();
+    std::cout << "TESTING: " << param.program << std::endl;
+    auto plain = parse_program(param.program);
+    auto folded = parse_program(param.program);
+    ConstantFolder folder;
+    folded->accept(folder);
+
+    auto expected = run<InterpreterVisitor>(*plain);
+    for (const auto& actual : {run<InterpreterVisitor>(*folded), run<VirtualMachine>(*folded)}) {
+        EXPECT_EQ(actual.value, expected.value);
+        EXPECT_EQ(actual.output, expected.output);
+        EXPECT_EQ(actual.error, expected.error);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    FoldedPrograms,
+    FoldedParityTest,
+    ::testing::Values(
+        FoldedProgram{"int main { ret 2 * 3 + 4; }"},
+        FoldedProgram{"int main { ret -(1 + 2) * 7 / 2; }"},
+        FoldedProgram{"flt main { ret 1.5 * 2 + 0.25; }"},
+        FoldedProgram{"int main { ret -2.5 + 1; }"},
+        FoldedProgram{"bool main { ret !(1 < 2) || \"a\" == \"a\" && 3 >= 2.5; }"},
+        FoldedProgram{"int main { (\"-\" * 10 + \"\\n\") -> stdout; ret 0; }"},
+        FoldedProgram{"int main { ((\"x\" + 1.5 + true) + \"\\n\") -> stdout; ret 0; }"},
+        FoldedProgram{"int main { for (0 => mut int i; i < 3 * 2) {"
+                      "(\"LOG: \" + \"value: \" + i + \"\\n\") -> stdout; } -> increment; ret 0; }"},
+        FoldedProgram{"int main { \"1\" + 2 => int a; ret a * (2 - 2); }"},
+        FoldedProgram{"int main { if (1 > 2) { ret 1 / 0; } ret 1; }"},
+        FoldedProgram{"int main { ret \"a\" - 1; }"},
+        FoldedProgram{"int main { ret \"a\" * -1; }"},
+        FoldedProgram{"int main { (1 + 1) -> add_1 => int a; ret a; } int add_1 :: int a { ret a + 1; }"}
+    )
+);
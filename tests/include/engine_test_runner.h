@@ -0,0 +1,80 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "builtin_defines.h"
+#include "interpreter.h"
+#include "lexer.h"
+#include "parser.h"
+#include "vm.h"
+
+#define VERBOSE false
+
+/**
+ * @brief parser over a program given as a string, skipping function bodies if `lazy`
+ */
+inline auto get_parser(std::string string, bool lazy = false) -> std::shared_ptr<Parser> {
+    std::shared_ptr<std::stringstream> input = std::make_unique<std::stringstream>(string);
+    auto lexer = std::make_shared<Lexer>(input, VERBOSE);
+    auto parser = std::make_shared<Parser>(std::move(lexer));
+    if (lazy) parser->defer_bodies();
+    return parser;
+}
+
+inline auto parse_program(std::string string) -> std::unique_ptr<Program> {
+    return get_parser(std::move(string))->parse();
+}
+
+/**
+ * @brief what running a program produced: the value of `main`, the output and the error, if any
+ */
+struct EngineResult {
+    ValType value;
+    std::string output;
+    std::string error;
+};
+
+// redirects std::cout for its lifetime, also when the engine throws
+struct CaptureStdout {
+    std::stringstream buffer;
+    std::streambuf* original_buf = std::cout.rdbuf(buffer.rdbuf());
+    ~CaptureStdout() { std::cout.rdbuf(original_buf); }
+};
+
+/**
+ * @brief run a parsed program on the engine `E`, limiting its call depth if `max_depth` is set
+ */
+template <typename E>
+auto run(const Program& program, size_t max_depth = 0) -> EngineResult {
+    E engine(builtins);
+    if (max_depth > 0) engine.set_max_depth(max_depth);
+    CaptureStdout capture;
+    try {
+        if constexpr (std::is_same_v<E, VirtualMachine>) {
+            engine.run(program);
+        } else {
+            program.accept(engine);
+        }
+    } catch (const GeneralError& e) {
+        return {{}, capture.buffer.str(), e.what()};
+    }
+    return {engine.get_value(), capture.buffer.str(), ""};
+}
+
+/**
+ * @brief parse and run a program on the engine `E`, reporting syntax errors like runtime ones
+ */
+template <typename E>
+auto run(std::string source, size_t max_depth = 0) -> EngineResult {
+    std::unique_ptr<Program> program;
+    try {
+        program = parse_program(std::move(source));
+    } catch (const GeneralError& e) {
+        return {{}, "", e.what()};
+    }
+    return run<E>(*program, max_depth);
+}
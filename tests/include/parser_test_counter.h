@@ -74,7 +74,7 @@ public:
     void visit(const BindFrtExpr& expr) override {
         bind_frt_expr_count++;
         expr.get_func_name()->accept(*this);
-        for (auto& arg : expr.get_args()) {
+        for (const auto* arg : expr.get_args()) {
             arg->accept(*this);
         }
     }
@@ -127,7 +127,7 @@ public:
     // Other visitors
     void visit(const Block& block) override {
         block_count++;
-        for (auto& stmt : block.get_statements()) {
+        for (const auto* stmt : block.get_statements()) {
             stmt->accept(*this);
         }
     }
@@ -146,7 +146,7 @@ public:
         } else {
             void_count++;
         }
-        for (auto& arg : sign.get_params()) {
+        for (const auto* arg : sign.get_params()) {
             arg->accept(*this);
         }
     }
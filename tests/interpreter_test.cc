@@ -3,6 +3,7 @@
 #include "lexer.h"
 #include "parser.h"
 #include "interpreter.h"
+#include "resolver.h"
 #include "builtin_defines.h"
 
 #define VERBOSE false
@@ -59,25 +60,27 @@ TEST(InterpreterTest, InterpreterAddDoubleInt) {
 TEST(InterpreterTest, InterpreterAssignBasic) {
     std::shared_ptr<InterpreterVisitor> interpreter = std::make_shared<InterpreterVisitor>();
     auto parser = get_parser("1 => int a;", true);
-    interpreter->push_call_stack(CallStackFrame({}, {BlockScope{}}));
+    interpreter->push_call_stack();
+    interpreter->push_scope();
     auto stmt = parser->parse_statement();
     stmt->accept(*interpreter);
 
-    std::weak_ptr<Variable> var = interpreter->find_var_in_frame("a");
-    ValType value = var.lock()->value;
+    Variable* var = interpreter->find_var_in_frame("a");
+    ValType value = var->value;
 
     VarType type = VarType(BaseType::INT, false);
 
     ASSERT_TRUE(std::holds_alternative<int>(value));
     EXPECT_EQ(std::get<int>(value), 1);
-    EXPECT_TRUE(type.is_equal_to(var.lock()->signature.get_type()));
+    EXPECT_TRUE(type.is_equal_to(var->get_type()));
 }
 
 TEST(InterpreterTest, InterpreterReAssignBasic) {
     std::shared_ptr<InterpreterVisitor> interpreter = std::make_shared<InterpreterVisitor>();
     auto parser_assign = get_parser("1 => mut int a;", true);
     auto parser_reassign = get_parser("2 => a;", true);
-    interpreter->push_call_stack(CallStackFrame({}, {BlockScope{}}));
+    interpreter->push_call_stack();
+    interpreter->push_scope();
 
     auto stmt = parser_assign->parse_statement();
     auto stmt_reassign = parser_reassign->parse_statement();
@@ -85,21 +88,22 @@ TEST(InterpreterTest, InterpreterReAssignBasic) {
     stmt->accept(*interpreter);
     stmt_reassign->accept(*interpreter);
 
-    std::weak_ptr<Variable> var = interpreter->find_var_in_frame("a");
-    ValType value = var.lock()->value;
+    Variable* var = interpreter->find_var_in_frame("a");
+    ValType value = var->value;
 
     VarType type = VarType(BaseType::INT, true);
 
     ASSERT_TRUE(std::holds_alternative<int>(value));
     EXPECT_EQ(std::get<int>(value), 2);
-    EXPECT_TRUE(type.is_equal_to(var.lock()->signature.get_type()));
+    EXPECT_TRUE(type.is_equal_to(var->get_type()));
 }
 
 TEST(InterpreterTest, InterpreterWhileBasic) {
     std::shared_ptr<InterpreterVisitor> interpreter = std::make_shared<InterpreterVisitor>();
     auto parser_assign = get_parser("1 => mut int i;", true);
     auto parser_reassign = get_parser("while (i < 5) { i + 1 => i; }", true);
-    interpreter->push_call_stack(CallStackFrame({}, {BlockScope{}}));
+    interpreter->push_call_stack();
+    interpreter->push_scope();
 
     auto stmt = parser_assign->parse_statement();
     auto stmt_reassign = parser_reassign->parse_statement();
@@ -107,14 +111,14 @@ TEST(InterpreterTest, InterpreterWhileBasic) {
     stmt->accept(*interpreter);
     stmt_reassign->accept(*interpreter);
 
-    std::weak_ptr<Variable> var = interpreter->find_var_in_frame("i");
-    ValType value = var.lock()->value;
+    Variable* var = interpreter->find_var_in_frame("i");
+    ValType value = var->value;
 
     VarType type = VarType(BaseType::INT, true);
 
     ASSERT_TRUE(std::holds_alternative<int>(value));
     EXPECT_EQ(std::get<int>(value), 5);
-    EXPECT_TRUE(type.is_equal_to(var.lock()->signature.get_type()));
+    EXPECT_TRUE(type.is_equal_to(var->get_type()));
 }
 
 TEST(InterpreterTest, InterpreterProgram) {
@@ -512,6 +516,141 @@ TEST(InterpreterTest, InterpreterForLoopIdentifier) {
 
 
 
+TEST(InterpreterTest, ResolverAssignsSlots) {
+    auto parser = get_parser(
+        "int main :: int p {"
+        "    1 => mut int a;"
+        "    if (a > 0) {"
+        "        2 => int b;"
+        "        b + p => a;"
+        "    }"
+        "    ret a;"
+        "}",
+    false);
+
+    auto program = parser->parse();
+    Resolver resolver;
+    program->accept(resolver);
+
+    auto statements = program->get_functions()[0]->get_body()->get_statements();
+    auto declaration = dynamic_cast<const AssignStatement*>(statements[0]);
+    ASSERT_TRUE(declaration->get_slot().has_value());
+    EXPECT_EQ(declaration->get_slot()->depth, 1u);
+    EXPECT_EQ(declaration->get_slot()->slot, 0u);
+
+    auto conditional = dynamic_cast<const ConditionalStatement*>(statements[1]);
+    auto inner = conditional->get_body()->get_statements();
+    auto inner_declaration = dynamic_cast<const AssignStatement*>(inner[0]);
+    EXPECT_EQ(inner_declaration->get_slot()->depth, 2u);
+    EXPECT_EQ(inner_declaration->get_slot()->slot, 0u);
+
+    auto reassign = dynamic_cast<const AssignStatement*>(inner[1]);
+    EXPECT_EQ(reassign->get_slot()->depth, 1u);
+    EXPECT_EQ(reassign->get_slot()->slot, 0u);
+
+    auto sum = dynamic_cast<const BinaryExpr*>(reassign->get_value());
+    auto param = dynamic_cast<const IdentifierExpr*>(sum->get_right());
+    EXPECT_EQ(param->get_slot()->depth, 0u);
+    EXPECT_EQ(param->get_slot()->slot, 0u);
+}
+
+TEST(InterpreterTest, ResolverLeavesRedefinitionUnresolved) {
+    auto parser = get_parser("int main { 1 => int a; 2 => int a; ret b; }", false);
+
+    auto program = parser->parse();
+    Resolver resolver;
+    program->accept(resolver);
+
+    auto statements = program->get_functions()[0]->get_body()->get_statements();
+    EXPECT_TRUE(dynamic_cast<const AssignStatement*>(statements[0])->get_slot().has_value());
+    EXPECT_FALSE(dynamic_cast<const AssignStatement*>(statements[1])->get_slot().has_value());
+
+    auto ret = dynamic_cast<const RetStatement*>(statements[2]);
+    EXPECT_FALSE(dynamic_cast<const IdentifierExpr*>(ret->get_retval())->get_slot().has_value());
+}
+
+
+TEST(InterpreterTest, ResolverBindsGlobalFunctions) {
+    std::shared_ptr<InterpreterVisitor> interpreter = std::make_shared<InterpreterVisitor>(builtins);
+    auto parser = get_parser(
+        "int main { 0 => mut int a; (a) -> increment; ret (a) -> add_1; }"
+        "int add_1 :: mut int a { ret a + 1; }",
+        false);
+
+    auto program = parser->parse();
+    program->accept(*interpreter);
+
+    ValType value = interpreter->get_value();
+    ASSERT_TRUE(std::holds_alternative<int>(value));
+    EXPECT_EQ(std::get<int>(value), 2);
+
+    auto statements = program->get_functions()[0]->get_body()->get_statements();
+    auto call_stmt = dynamic_cast<const CallStatement*>(statements[1]);
+    auto call = dynamic_cast<const CallExpr*>(call_stmt->get_call());
+    auto callee = dynamic_cast<const IdentifierExpr*>(call->get_func_name());
+    EXPECT_EQ(callee->get_function(), interpreter->find_func("increment"));
+
+    auto ret = dynamic_cast<const RetStatement*>(statements[2]);
+    auto ret_call = dynamic_cast<const CallExpr*>(ret->get_retval());
+    auto ret_callee = dynamic_cast<const IdentifierExpr*>(ret_call->get_func_name());
+    EXPECT_EQ(ret_callee->get_function(), interpreter->find_func("add_1"));
+
+    auto arg = dynamic_cast<const IdentifierExpr*>(ret_call->get_args()[0]);
+    EXPECT_EQ(arg->get_function(), nullptr);
+}
+
+
+TEST(InterpreterTest, ResolverInfersOperandTypes) {
+    auto parser = get_parser(
+        "int main :: flt f, [int::int] g {"
+        "    1 => int a;"
+        "    a + 2 => int b;"
+        "    f * 1.5 => flt c;"
+        "    a + f => flt d;"
+        "    \"x\" + a == \"x1\" => bool e;"
+        "    g + a => int h;"
+        "}",
+    false);
+
+    auto program = parser->parse();
+    Resolver resolver;
+    program->accept(resolver);
+
+    auto statements = program->get_functions()[0]->get_body()->get_statements();
+    auto operand_type = [&](size_t i) {
+        auto assign = dynamic_cast<const AssignStatement*>(statements[i]);
+        return dynamic_cast<const BinaryExpr*>(assign->get_value())->get_operand_type();
+    };
+    EXPECT_EQ(operand_type(1), BaseType::INT);
+    EXPECT_EQ(operand_type(2), BaseType::FLT);
+    EXPECT_EQ(operand_type(3), std::nullopt);
+    // the concatenation is known to produce a string
+    EXPECT_EQ(operand_type(4), BaseType::STRING);
+    EXPECT_EQ(operand_type(5), std::nullopt);
+}
+
+
+TEST(InterpreterTest, BoundFunctionsAreFlattened) {
+    auto program = get_parser("int digits :: int a, int b, int c { ret a * 100 + b * 10 + c; }")->parse();
+    auto digits = std::make_shared<GlobalFunction>(program->get_functions()[0]);
+
+    auto first = std::make_shared<LocalFunction>(digits, ArgVector{ValType{1}});
+    auto both = std::make_shared<LocalFunction>(first, ArgVector{ValType{2}});
+    auto direct = std::make_shared<LocalFunction>(digits, ArgVector{ValType{1}, ValType{2}});
+
+    // binding a bound function binds both lists to the original callee, sharing its type
+    EXPECT_EQ(both->bound_count(), 2u);
+    EXPECT_EQ(both->get_type(), direct->get_type());
+    EXPECT_EQ(both->get_type()->get_params().size(), 1u);
+    EXPECT_EQ(first->get_type()->get_params().size(), 2u);
+
+    InterpreterVisitor interpreter(builtins);
+    ArgVector args{ValType{3}};
+    both->call(interpreter, args);
+    EXPECT_EQ(interpreter.get_value(), ValType{123});
+}
+
+
 enum class ValKind {
     Int,
     Double,
@@ -607,6 +746,40 @@ INSTANTIATE_TEST_SUITE_P(
     )
 );
 
+struct LocatedError {
+    std::string program;
+    std::string error;
+};
+
+class InterpreterErrorLocation : public ::testing::TestWithParam<LocatedError> {};
+
+TEST_P(InterpreterErrorLocation, LocatesErrorAtInnermostNode) {
+    const auto& param = GetParam();
+    InterpreterVisitor interpreter(builtins);
+    auto program = get_parser(param.program, false)->parse();
+    try {
+        program->accept(interpreter);
+        FAIL() << "expected an error";
+    } catch (const GeneralError& e) {
+        EXPECT_EQ(std::string(e.what()), param.error);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LocatedErrors,
+    InterpreterErrorLocation,
+    ::testing::Values(
+        LocatedError{"int main {\n    ret (1) -> f;\n}\n"
+                     "int f :: int n {\n    if (n > 0) { (n + y) -> stdout; }\n    ret 0;\n}",
+                     "\x1b[1;31mException thrown at 5:20\x1b[0m - Unknown identifier"},
+        LocatedError{"int main {\n    1 => int a;\n    (a) -> f;\n    ret 0;\n}\n"
+                     "void f :: int n {\n    while (n > 0) { 2 => int n; }\n}",
+                     "\x1b[1;31mException thrown at 7:21\x1b[0m - Variable n is already defined in this frame"},
+        LocatedError{"int main {\n    1 => int a;\n    0 => b;\n    ret 0;\n}",
+                     "\x1b[1;31mException thrown at 3:5\x1b[0m - Variable not in scope: b"}
+    )
+);
+
 struct InvalidProgram {
     std::string program;
 };
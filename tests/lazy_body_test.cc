@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "program_stream.h"
+#include "constant_folder.h"
+#include "engine_test_runner.h"
+
+TEST(LazyBodyTest, SkipsBodiesUntilCalled) {
+    auto program = get_parser(
+        "int main { ret (1) -> used; }"
+        "int used :: int a { ret a + 1; }"
+        "int unused { if (true) { ret 1; } ret 0; }", true)->parse();
+
+    auto functions = program->get_functions();
+    ASSERT_EQ(functions.size(), 3u);
+    for (const auto* func : functions) EXPECT_EQ(func->get_body(), nullptr);
+
+    auto result = run<VirtualMachine>(*program);
+    EXPECT_EQ(result.value, ValType{2});
+    EXPECT_NE(functions[0]->get_body(), nullptr);
+    EXPECT_NE(functions[1]->get_body(), nullptr);
+    EXPECT_EQ(functions[2]->get_body(), nullptr);
+}
+
+TEST(LazyBodyTest, ParsesBodyOnce) {
+    auto program = get_parser("int main { ret 0; }", true)->parse();
+    const Function* main = program->get_functions()[0];
+
+    EXPECT_TRUE(main->parse_body());
+    const Block* body = main->get_body();
+    ASSERT_NE(body, nullptr);
+    EXPECT_EQ(body->get_statements().size(), 1u);
+
+    EXPECT_FALSE(main->parse_body());
+    EXPECT_EQ(main->get_body(), body);
+}
+
+TEST(LazyBodyTest, PlacesBodyInProgramArena) {
+    auto program = get_parser("int main { 1 + 2 => int a; ret a; }", true)->parse();
+    const Function* main = program->get_functions()[0];
+    main->parse_body();
+
+    ASSERT_NE(program->get_arena(), nullptr);
+    EXPECT_TRUE(program->get_arena()->contains(main->get_body()));
+}
+
+TEST(LazyBodyTest, RejectsUnbalancedBraces) {
+    EXPECT_THROW(get_parser("int main { if (true) { ret 0; }", true)->parse(), ParserError);
+}
+
+TEST(LazyBodyTest, ReportsSyntaxErrorsOnFirstCall) {
+    auto program = get_parser(
+        "int main {\n"
+        "    ret (1) -> broken;\n"
+        "}\n"
+        "int broken :: int a {\n"
+        "    ret a +;\n"
+        "}\n"
+        "int never { ret 0 }\n", true)->parse();
+
+    auto result = run<InterpreterVisitor>(*program);
+    EXPECT_NE(result.error.find("thrown at 5:"), std::string::npos) << result.error;
+}
+
+TEST(LazyBodyTest, FoldsBodiesWhenParsed) {
+    std::shared_ptr<Parser> parser = get_parser("int main { ret 2 * 3; }", true);
+    parser->defer_bodies([](const Function& func) {
+        ConstantFolder folder;
+        func.accept(folder);
+    });
+    auto program = parser->parse();
+    const Function* main = program->get_functions()[0];
+    main->parse_body();
+
+    auto ret = dynamic_cast<const RetStatement*>(main->get_body()->get_statements()[0]);
+    auto product = dynamic_cast<const BinaryExpr*>(ret->get_retval());
+    ASSERT_TRUE(product->get_folded().has_value());
+    EXPECT_EQ(std::get<int>(*product->get_folded()), 6);
+}
+
+struct LazyProgram {
+    std::string program;
+};
+
+class LazyParityTest : public ::testing::TestWithParam<LazyProgram> {};
+
+TEST_P(LazyParityTest, MatchesEagerProgram) {
+    const auto& param = GetParam();
+    std::cout << "TESTING: " << param.program << std::endl;
+
+    auto eager = get_parser(param.program, false)->parse();
+    auto lazy = get_parser(param.program, true)->parse();
+
+    auto tree_expected = run<InterpreterVisitor>(*eager);
+    auto tree_actual = run<InterpreterVisitor>(*lazy);
+    EXPECT_EQ(tree_actual.value, tree_expected.value);
+    EXPECT_EQ(tree_actual.output, tree_expected.output);
+    EXPECT_EQ(tree_actual.error, tree_expected.error);
+
+    // the bodies of the second program are parsed by now, run it from scratch
+    lazy = get_parser(param.program, true)->parse();
+    auto vm_expected = run<VirtualMachine>(*eager);
+    auto vm_actual = run<VirtualMachine>(*lazy);
+    EXPECT_EQ(vm_actual.value, vm_expected.value);
+    EXPECT_EQ(vm_actual.output, vm_expected.output);
+    EXPECT_EQ(vm_actual.error, vm_expected.error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LazyPrograms,
+    LazyParityTest,
+    ::testing::Values(
+        LazyProgram{"int main { ret 5; }"},
+        LazyProgram{"int main { ret (10) -> recur_sum; }"
+                    "int recur_sum :: int n { if (n <= 1) { ret n; } ret ((n - 1) -> recur_sum) + n; }"},
+        LazyProgram{"int main { 0 => mut int a; while (a < 5) { if (a == 3) { (a) -> stdout; } a + 1 => a; } ret a; }"},
+        LazyProgram{"int main { (add_1) -> apply => int a; ret a; }"
+                    "int apply :: [int::int] f { ret (1) -> f; } int add_1 :: int a { ret a + 1; }"},
+        LazyProgram{"int main { add_1 @ decorator => [int::] decorated; ret () -> decorated; }"
+                    "int decorator :: [int::int] func { (5) -> func => int a; ret a + 1; }"
+                    "int add_1 :: int a { ret a + 1; }"},
+        LazyProgram{"int main { for (0 => mut int i; i < 3) { (\"{\" + i + \"}\") -> stdout; } -> increment; ret 0; }"},
+        LazyProgram{"int main { // } {\n ret (1) -> f; }\n int f :: int a { ret a * 2; }"},
+        LazyProgram{"int main { (\"a\") -> stdout; ret (1) -> nonexistent; }"},
+        LazyProgram{"int main { ret 0; } int main { ret 1; }"}
+    )
+);
+
+TEST(LazyBodyTest, CombinesWithStreaming) {
+    auto parser = get_parser(
+        "int main { ret (2) -> twice; }"
+        "int twice :: int a { ret a * 2; }"
+        "int unused { ret 0; }", true);
+    ProgramStream stream(parser);
+    VirtualMachine vm(builtins);
+    vm.run(stream);
+
+    EXPECT_EQ(vm.get_value(), ValType{4});
+    auto functions = stream.get_program().get_functions();
+    ASSERT_EQ(functions.size(), 3u);
+    EXPECT_EQ(functions[2]->get_body(), nullptr);
+}
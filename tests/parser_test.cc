@@ -3,10 +3,24 @@
 #include "lexer.h"
 #include "parser.h"
 
+#include <cstdlib>
 #include <memory>
+#include <new>
 
 #define VERBOSE false
 
+// counts heap allocations made by the test binary
+static size_t allocation_count = 0;
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
 Lexer get_lexer_for_string(std::string string) {
     std::shared_ptr<std::stringstream> input = std::make_unique<std::stringstream>(string);
     Lexer lexer(input, VERBOSE);
@@ -135,3 +149,71 @@ TEST(ParserTest, ParsesMultipleFunctions) {
     EXPECT_EQ(counter->block_count, 2);
 }
 
+
+TEST(ParserTest, InternsIdentifiers) {
+    auto parser = get_parser("int add :: int lhs, int rhs { ret lhs + rhs; } int main { ret (1, 2) -> add; }");
+    auto program = parser->parse();
+    ASSERT_NE(program, nullptr);
+
+    const auto functions = program->get_functions();
+    ASSERT_EQ(functions.size(), 2u);
+    const auto* add = functions[0]->get_signature();
+    EXPECT_EQ(add->get_symbol(), Symbol("add"));
+    EXPECT_NE(add->get_symbol(), functions[1]->get_signature()->get_symbol());
+
+    const auto params = add->get_params();
+    ASSERT_EQ(params.size(), 2u);
+    EXPECT_EQ(params[0]->get_symbol(), Symbol("lhs"));
+    EXPECT_EQ(params[1]->get_symbol(), *Symbol::find("rhs"));
+    EXPECT_EQ(params[1]->get_name(), "rhs");
+
+    // looking up a name does not intern it
+    EXPECT_FALSE(Symbol::find("never_parsed_identifier").has_value());
+}
+
+TEST(ParserTest, WalkingVisitedBlockDoesNotAllocate) {
+    auto parser = get_parser(
+        "int main :: int n {"
+        "    0 => mut int a;"
+        "    while (a < n) { (a) -> increment; }"
+        "    for (0 => mut int i; i < 5) { (i, a) -> print; } -> increment;"
+        "    (1) ->> add => [int::int] add_1;"
+        "    if (a > 1) { ret (a, 2) -> add; } else { ret -a; }"
+        "}");
+    auto program = parser->parse();
+    ASSERT_NE(program, nullptr);
+    const Block* body = program->get_functions()[0]->get_body();
+
+    ParserTestCounter first;
+    body->accept(first);
+
+    ParserTestCounter second;
+    const size_t before = allocation_count;
+    body->accept(second);
+    EXPECT_EQ(allocation_count, before);
+    EXPECT_EQ(second.identifier_expr_count, first.identifier_expr_count);
+}
+
+TEST(ParserTest, AllocatesNodesInProgramArena) {
+    auto parser = get_parser("int main { 1 => int a; 2 => int b; ret a + b; } int other {}");
+    auto program = parser->parse();
+    ASSERT_NE(program, nullptr);
+    const Arena* arena = program->get_arena();
+    ASSERT_NE(arena, nullptr);
+
+    const auto functions = program->get_functions();
+    EXPECT_TRUE(arena->contains(functions[0]));
+    EXPECT_TRUE(arena->contains(functions[1]->get_signature()->get_type()));
+
+    // nodes are laid out in parse order
+    const auto statements = functions[0]->get_body()->get_statements();
+    ASSERT_EQ(statements.size(), 3u);
+    for (const auto* stmt : statements) EXPECT_TRUE(arena->contains(stmt));
+    EXPECT_LT(static_cast<const void*>(statements[0]), static_cast<const void*>(statements[1]));
+    EXPECT_LT(static_cast<const void*>(statements[1]), static_cast<const void*>(statements[2]));
+    EXPECT_LT(static_cast<const void*>(statements[2]), static_cast<const void*>(functions[1]));
+
+    // nodes created outside of parsing come from the heap
+    auto type = functions[0]->get_signature()->get_type()->clone();
+    EXPECT_FALSE(arena->contains(type.get()));
+}
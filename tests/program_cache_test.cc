@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "program_cache.h"
+#include "program_stream.h"
+#include "constant_folder.h"
+#include "engine_test_runner.h"
+
+std::shared_ptr<const SourceBuffer> get_source(std::string string) {
+    std::stringstream input(string);
+    return SourceBuffer::from_stream(input);
+}
+
+std::unique_ptr<Program> parse(std::shared_ptr<const SourceBuffer> source, bool fold) {
+    auto program = Parser(std::make_shared<Lexer>(std::move(source), VERBOSE)).parse();
+    if (fold) {
+        ConstantFolder folder;
+        program->accept(folder);
+    }
+    return program;
+}
+
+std::string print(const Program& program) {
+    std::stringstream output;
+    ParserPrinter printer(output);
+    program.accept(printer);
+    return output.str();
+}
+
+class ProgramCacheTest : public ::testing::Test {
+   protected:
+    std::string path = ::testing::TempDir() + "program_cache_test.tkomc";
+
+    void TearDown() override { std::filesystem::remove(path); }
+};
+
+const std::string source_text =
+    "int main {"
+    "    2 * 3 + 1 => mut int a;"
+    "    for (0 => mut int i; i < 3) { (\"i=\" + i + \"\\n\") -> stdout; } -> increment;"
+    "    if (a > 10) { 0 => a; } elif (!(a == 7)) { 1 => a; } else { -a => a; }"
+    "    while (a < 0) { a + 10 => a; }"
+    "    add @ logged => [int::int, int] decorated;"
+    "    (4, 5) -> decorated => int b;"
+    "    (1) ->> add => [int::int] add_1;"
+    "    ret ((b) -> add_1) + a;"
+    "}"
+    "int add :: int x, int y { ret x + y; }"
+    "int logged :: [int::int, int] func, int x, int y {"
+    "    (\"calling\\n\") -> stdout;"
+    "    ret (x, y) -> func;"
+    "}";
+
+TEST_F(ProgramCacheTest, RoundTripsProgram) {
+    auto source = get_source(source_text);
+    auto program = parse(source, true);
+    ProgramCache cache(path, true);
+    ASSERT_TRUE(cache.store(*program, *source));
+
+    auto cached = cache.load(*source);
+    ASSERT_NE(cached, nullptr);
+    EXPECT_EQ(print(*cached), print(*program));
+    EXPECT_NE(cached->get_arena(), nullptr);
+
+    for (const auto& [expected, actual] :
+         {std::pair{run<InterpreterVisitor>(*program), run<InterpreterVisitor>(*cached)},
+          std::pair{run<VirtualMachine>(*program), run<VirtualMachine>(*cached)}}) {
+        EXPECT_EQ(actual.value, expected.value);
+        EXPECT_EQ(actual.output, expected.output);
+        EXPECT_EQ(actual.error, expected.error);
+    }
+}
+
+TEST_F(ProgramCacheTest, KeepsFoldedConstants) {
+    auto source = get_source("int main { ret 2 * 3 + 1; }");
+    ProgramCache cache(path, true);
+    ASSERT_TRUE(cache.store(*parse(source, true), *source));
+
+    auto cached = cache.load(*source);
+    ASSERT_NE(cached, nullptr);
+    const auto* ret = dynamic_cast<const RetStatement*>(
+        cached->get_functions()[0]->get_body()->get_statements()[0]);
+    ASSERT_NE(ret, nullptr);
+    const auto* expr = dynamic_cast<const BinaryExpr*>(ret->get_retval());
+    ASSERT_NE(expr, nullptr);
+    ASSERT_TRUE(expr->get_folded().has_value());
+    EXPECT_EQ(std::get<int>(*expr->get_folded()), 7);
+}
+
+TEST_F(ProgramCacheTest, MissesOnChangedSource) {
+    auto source = get_source("int main { ret 1; }");
+    ASSERT_TRUE(ProgramCache(path, true).store(*parse(source, true), *source));
+
+    EXPECT_EQ(ProgramCache(path, true).load(*get_source("int main { ret 2; }")), nullptr);
+    EXPECT_EQ(ProgramCache(path, false).load(*source), nullptr);
+    EXPECT_NE(ProgramCache(path, true).load(*source), nullptr);
+}
+
+TEST_F(ProgramCacheTest, MissesOnDamagedImage) {
+    auto source = get_source(source_text);
+    ProgramCache cache(path, false);
+    EXPECT_EQ(cache.load(*source), nullptr);
+    ASSERT_TRUE(cache.store(*parse(source, false), *source));
+
+    const auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size / 2);
+    EXPECT_EQ(cache.load(*source), nullptr);
+
+    std::ofstream(path, std::ios::binary) << "not a cache";
+    EXPECT_EQ(cache.load(*source), nullptr);
+}
+
+TEST_F(ProgramCacheTest, MissesOnInvalidConditional) {
+    auto source = get_source("int main { if (true) { ret 1; } ret 0; }");
+    auto program = parse(source, false);
+    ProgramCache cache(path, false);
+    ASSERT_TRUE(cache.store(*program, *source));
+
+    // the position of the conditional is followed by whether it is an `if` or an `elif`
+    const Position pos =
+        program->get_functions()[0]->get_body()->get_statements()[0]->get_position();
+    const auto encode = [pos](TokenType type) {
+        std::string bytes;
+        const auto line = pos.get_line();
+        const auto column = pos.get_column();
+        bytes.append(reinterpret_cast<const char*>(&line), sizeof(line));
+        bytes.append(reinterpret_cast<const char*>(&column), sizeof(column));
+        bytes.append(reinterpret_cast<const char*>(&type), sizeof(type));
+        return bytes;
+    };
+
+    std::string image;
+    {
+        std::ifstream file(path, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    const auto at = image.find(encode(TokenType::T_IF));
+    ASSERT_NE(at, std::string::npos);
+    image.replace(at, encode(TokenType::T_WHILE).size(), encode(TokenType::T_WHILE));
+    std::ofstream(path, std::ios::binary) << image;
+
+    EXPECT_EQ(cache.load(*source), nullptr);
+}
+
+TEST_F(ProgramCacheTest, StoresStreamedProgram) {
+    auto source = get_source(source_text);
+    ProgramStream stream(std::make_shared<Parser>(std::make_shared<Lexer>(source, VERBOSE)));
+    while (stream.next()) {}
+    ProgramCache cache(path, false);
+    ASSERT_TRUE(cache.store(stream.get_program(), *source));
+
+    auto cached = cache.load(*source);
+    ASSERT_NE(cached, nullptr);
+    EXPECT_EQ(print(*cached), print(*parse(source, false)));
+}
+
+TEST_F(ProgramCacheTest, RefusesSkippedBodies) {
+    auto source = get_source("int main { ret 1; }");
+    Parser parser(std::make_shared<Lexer>(source, VERBOSE));
+    parser.defer_bodies();
+    auto program = parser.parse();
+
+    EXPECT_FALSE(ProgramCache(path, false).store(*program, *source));
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(ProgramCachePathTest, StoresNextToSourceOrInCacheDirectory) {
+    EXPECT_EQ(ProgramCache::path_for("dir/file.tkom"), "dir/file.tkomc");
+    EXPECT_EQ(ProgramCache::path_for("script"), "script.tkomc");
+
+    const auto first = ProgramCache::path_for("a/file.tkom", "cache");
+    const auto second = ProgramCache::path_for("b/file.tkom", "cache");
+    EXPECT_NE(first, second);
+    EXPECT_EQ(std::filesystem::path(first).parent_path(), "cache");
+    EXPECT_EQ(std::filesystem::path(first).extension(), ".tkomc");
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "program_stream.h"
+#include "engine_test_runner.h"
+
+template <typename E>
+EngineResult run_stream(std::string source) {
+    E engine(builtins);
+    CaptureStdout capture;
+    ProgramStream stream(get_parser(source));
+    try {
+        engine.run(stream);
+    } catch (const GeneralError& e) {
+        return {{}, capture.buffer.str(), e.what()};
+    }
+    return {engine.get_value(), capture.buffer.str(), ""};
+}
+
+TEST(ProgramStreamTest, ParsesOneFunctionAtATime) {
+    ProgramStream stream(get_parser("int main { ret 0; } int a { ret 1; } int b { ret 2; }"));
+
+    EXPECT_EQ(stream.next()->get_signature()->get_name(), "main");
+    EXPECT_EQ(stream.get_program().get_functions().size(), 1u);
+    EXPECT_EQ(stream.next()->get_signature()->get_name(), "a");
+    EXPECT_EQ(stream.next()->get_signature()->get_name(), "b");
+    EXPECT_FALSE(stream.is_finished());
+    EXPECT_EQ(stream.next(), nullptr);
+    EXPECT_TRUE(stream.is_finished());
+    EXPECT_EQ(stream.get_program().get_functions().size(), 3u);
+}
+
+TEST(ProgramStreamTest, LoadsFunctionsOnDemand) {
+    const std::string source =
+        "int main { ret (1) -> used; }"
+        "int used :: int a { ret a + 1; }"
+        "int unused { ret 0; }";
+
+    ProgramStream stream(get_parser(source));
+    FunctionTable functions(builtins);
+    functions.stream_from(&stream);
+
+    ASSERT_NE(functions.load(Symbol("used")), nullptr);
+    EXPECT_EQ(stream.get_program().get_functions().size(), 2u);
+    EXPECT_EQ(functions.find(Symbol("unused")), nullptr);
+
+    functions.load_all();
+    EXPECT_NE(functions.find(Symbol("unused")), nullptr);
+}
+
+TEST(ProgramStreamTest, RunsMainBeforeLaterSyntaxErrors) {
+    const std::string source =
+        "int main { (\"started\") -> stdout; ret 0; }"
+        "int broken { ret 0 }";
+
+    for (const auto& result : {run_stream<InterpreterVisitor>(source),
+                               run_stream<VirtualMachine>(source)}) {
+        EXPECT_EQ(result.output, "started");
+        EXPECT_FALSE(result.error.empty());
+    }
+}
+
+TEST(ProgramStreamTest, ReportsLaterRedefinitions) {
+    const std::string source = "int main { ret 0; } int a { ret 1; } int a { ret 2; }";
+
+    EXPECT_EQ(run_stream<InterpreterVisitor>(source).error, run<InterpreterVisitor>(source).error);
+    EXPECT_EQ(run_stream<VirtualMachine>(source).error, run<VirtualMachine>(source).error);
+}
+
+struct StreamProgram {
+    std::string program;
+};
+
+class StreamParityTest : public ::testing::TestWithParam<StreamProgram> {};
+
+TEST_P(StreamParityTest, MatchesWholeProgram) {
+    const auto& param = GetParam();
+    std::cout << "TESTING: " << param.program << std::endl;
+
+    auto tree_expected = run<InterpreterVisitor>(param.program);
+    auto tree_actual = run_stream<InterpreterVisitor>(param.program);
+    EXPECT_EQ(tree_actual.value, tree_expected.value);
+    EXPECT_EQ(tree_actual.output, tree_expected.output);
+    EXPECT_EQ(tree_actual.error, tree_expected.error);
+
+    auto vm_expected = run<VirtualMachine>(param.program);
+    auto vm_actual = run_stream<VirtualMachine>(param.program);
+    EXPECT_EQ(vm_actual.value, vm_expected.value);
+    EXPECT_EQ(vm_actual.output, vm_expected.output);
+    EXPECT_EQ(vm_actual.error, vm_expected.error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    StreamPrograms,
+    StreamParityTest,
+    ::testing::Values(
+        StreamProgram{"int main { ret 5; }"},
+        StreamProgram{"int main { ret (10) -> recur_sum; }"
+                      "int recur_sum :: int n { if (n <= 1) { ret n; } ret ((n - 1) -> recur_sum) + n; }"},
+        StreamProgram{"int add_1 :: int a { ret a + 1; } int main { ret (1) -> add_1; }"},
+        StreamProgram{"int main { ret (1) -> first; }"
+                      "int first :: int a { ret (a) -> second; }"
+                      "int second :: int a { ret a * 2; }"},
+        StreamProgram{"int main { (add_1) -> apply => int a; ret a; }"
+                      "int apply :: [int::int] f { ret (1) -> f; } int add_1 :: int a { ret a + 1; }"},
+        StreamProgram{"int main { add_1 @ decorator => [int::] decorated; ret () -> decorated; }"
+                      "int decorator :: [int::int] func { (5) -> func => int a; ret a + 1; }"
+                      "int add_1 :: int a { ret a + 1; }"},
+        StreamProgram{"int main { (\"a\") -> stdout; ret (1) -> nonexistent; }"},
+        StreamProgram{"int main { 0 => int a; if (a > 0) { ret (a) -> missing; } ret a; }"},
+        StreamProgram{"int main { ret 0; } int main { ret 1; }"}
+    )
+);
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "engine_test_runner.h"
+
+struct TailCallProgram {
+    std::string program;
+    ValType value;
+    std::string error = "";
+};
+
+class TailCallTest : public ::testing::TestWithParam<TailCallProgram> {};
+
+TEST_P(TailCallTest, RunsInConstantStack) {
+    const auto& param = GetParam();
+    std::cout << "TESTING: " << param.program << std::endl;
+
+    for (const auto& result : {run<InterpreterVisitor>(param.program),
+                               run<VirtualMachine>(param.program)}) {
+        EXPECT_EQ(result.error, param.error);
+        if (param.error.empty()) {
+            EXPECT_EQ(result.value, param.value);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TailCallPrograms,
+    TailCallTest,
+    ::testing::Values(
+        // far deeper than the value stack could hold as nested calls
+        TailCallProgram{"int main { ret (1000000, 0) -> count; }"
+                        "int count :: int n, int acc { if (n == 0) { ret acc; } ret (n - 1, acc + 1) -> count; }",
+                        1000000},
+        TailCallProgram{"int main { (1000001) -> is_odd => bool odd; if (odd) { ret 1; } ret 0; }"
+                        "bool is_even :: int n { if (n == 0) { ret true; } ret (n - 1) -> is_odd; }"
+                        "bool is_odd :: int n { if (n == 0) { ret false; } ret (n - 1) -> is_even; }",
+                        1},
+        TailCallProgram{"int main { ret (0, 1000000) -> step; }"
+                        "int step :: int acc, int n {"
+                        "    if (n == 0) { ret acc; }"
+                        "    (acc + 1) ->> step => [int::int] next;"
+                        "    ret (n - 1) -> next;"
+                        "}",
+                        1000000},
+        // locals of the replaced frame passed by reference
+        TailCallProgram{"int main { ret (1000000) -> down; }"
+                        "int down :: int n { if (n == 0) { ret 7; } n - 1 => int m; ret (m) -> down; }",
+                        7},
+        TailCallProgram{"int main { 1 => mut int x; ret (x) -> pass; }"
+                        "int pass :: mut int v { 10 => mut int y; ret (y, y) -> twice; }"
+                        "int twice :: mut int a, mut int b { a + 1 => a; ret b; }",
+                        11},
+        TailCallProgram{"int main { (3) ->> add => [int::int] add_3; \"ab\" => string s; ret (add_3, s) -> apply; }"
+                        "int add :: int a, int b { ret a + b; }"
+                        "int apply :: [int::int] f, string s { ret (s == \"ab\") -> f; }",
+                        4},
+        TailCallProgram{"int main { 1 => mut int x; (x) -> outer => int r; ret x * 100 + r; }"
+                        "int outer :: mut int v { ret (v) -> inner; }"
+                        "int inner :: mut int v { v + 1 => v; ret v; }",
+                        202},
+        // calls returned from within loops
+        TailCallProgram{"int main { ret (1000000) -> down; }"
+                        "int down :: int n { while (true) { if (n == 0) { ret 5; } ret (n - 1) -> down; } ret -1; }",
+                        5},
+        // a different return type needs the cast of the caller, so the call is not replaced
+        TailCallProgram{"int main { ret (7) -> half; } flt half :: int n { ret n / 2.0; }", 3},
+        TailCallProgram{"int main { (3) ->> mean => [flt::int] mean_3; ret (4) -> mean_3; }"
+                        "flt mean :: int a, int b { ret (a + b) / 2.0; }",
+                        3},
+        TailCallProgram{"int main { ret (1000) -> f; }"
+                        "int f :: int n { if (n == 0) { ret 7; } ret (n - 1) -> g; }"
+                        "flt g :: int n { ret (n) -> f; }",
+                        7},
+        // errors are reported where they were before the calls were replaced
+        TailCallProgram{"int main { ret (3) -> a; }\n"
+                        "int a :: int n { ret (n) -> b; }\n"
+                        "int b :: int n { ret \"x\"; }",
+                        {},
+                        "\x1b[1;31mException thrown at 2:26\x1b[0m - Cannot cast x to int"},
+        TailCallProgram{"int main { ret (3) -> a; }\n"
+                        "int a :: int n { ret (n, 1) -> b; }\n"
+                        "int b :: int n { ret n; }",
+                        {},
+                        "\x1b[1;31mException thrown at 2:29\x1b[0m - Invalid argument vector size"}
+    )
+);
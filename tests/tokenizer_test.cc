@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 #include "tokenizer.h"
 #include "input_manager.h"
+#include "exceptions.h"
 
 
 Tokenizer get_tokenizer_for_string(std::string string) {
@@ -12,8 +15,10 @@ Tokenizer get_tokenizer_for_string(std::string string) {
 }
 
 Token get_token_from_string(std::string string) {
-    Tokenizer tokenizer = get_tokenizer_for_string(string);
-    return tokenizer.get_token();
+    // tokens refer to the source held by their tokenizer, keep the last one alive
+    static std::unique_ptr<Tokenizer> tokenizer;
+    tokenizer = std::make_unique<Tokenizer>(get_tokenizer_for_string(string));
+    return tokenizer->get_token();
 }
 
 TEST(TokenizerIdentifier, TokenizerTestBasic) {
@@ -75,3 +80,83 @@ TEST(TokenizerComment, TokenizerTestBasic) {
     EXPECT_EQ(token3.get_type(), TokenType::T_IDENTIFIER);
     EXPECT_EQ(token3.get_value<std::string>(), "other");
 }
+
+TEST(TokenizerCommentPosition, TokenizerTestBasic) {
+    Tokenizer t = get_tokenizer_for_string("test // bla\r\n  other // end");
+    t.get_token();
+    t.get_token();
+    Token token = t.get_token();
+    EXPECT_EQ(token.get_value<std::string>(), "other");
+    EXPECT_EQ(token.get_position().get_line(), 2u);
+    EXPECT_EQ(token.get_position().get_column(), 3u);
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_COMMENT);
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_EOF);
+}
+
+TEST(TokenizerMappedFile, TokenizerTestBasic) {
+    const std::string filename = ::testing::TempDir() + "tokenizer_mapped.tkom";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "while\r\nx1 12.5";
+    }
+    std::shared_ptr<Position> position = std::make_unique<Position>();
+    auto manager = std::make_shared<InputManager>(position, SourceBuffer::from_file(filename));
+    Tokenizer t(manager);
+
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_WHILE);
+    Token identifier = t.get_token();
+    EXPECT_EQ(identifier.get_value<std::string>(), "x1");
+    EXPECT_EQ(identifier.get_position().get_line(), 2u);
+    EXPECT_EQ(t.get_token().get_value<double>(), 12.5);
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_EOF);
+    std::remove(filename.c_str());
+}
+
+TEST(TokenizerMissingFile, TokenizerTestBasic) {
+    auto source = SourceBuffer::from_file(::testing::TempDir() + "does_not_exist.tkom");
+    EXPECT_EQ(source->size(), 0u);
+}
+
+TEST(TokenizerStringEscape, TokenizerTestBasic) {
+    Tokenizer t = get_tokenizer_for_string("\"plain\" \"a\\tb\\n\" \"\"");
+    EXPECT_EQ(t.get_token().get_text(), "plain");
+    EXPECT_EQ(t.get_token().get_value<std::string>(), "a\tb\n");
+    EXPECT_EQ(t.get_token().get_text(), "");
+}
+
+TEST(TokenizerUnterminatedString, TokenizerTestBasic) {
+    Tokenizer t = get_tokenizer_for_string("\"abc");
+    EXPECT_THROW(t.get_token(), UnterminatedString);
+}
+
+TEST(TokenizerKeywordNearMiss, TokenizerTestBasic) {
+    Tokenizer t = get_tokenizer_for_string("elif eli elifs true truex mut Mut");
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_ELIF);
+    EXPECT_EQ(t.get_token().get_text(), "eli");
+    EXPECT_EQ(t.get_token().get_text(), "elifs");
+    Token boolean = t.get_token();
+    EXPECT_EQ(boolean.get_type(), TokenType::T_BOOL);
+    EXPECT_TRUE(boolean.get_value<bool>());
+    EXPECT_EQ(t.get_token().get_text(), "truex");
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_MUT);
+    EXPECT_EQ(t.get_token().get_text(), "Mut");
+}
+
+TEST(TokenizerIdentifierLength, TokenizerTestBasic) {
+    EXPECT_EQ(get_token_from_string(std::string(31, 'a') + "+").get_text(), std::string(31, 'a'));
+    EXPECT_THROW(get_token_from_string(std::string(32, 'a')), IdentifierLengthExceeded);
+}
+
+TEST(TokenizerLongRuns, TokenizerTestBasic) {
+    const std::string text(40, 'x');
+    Tokenizer t = get_tokenizer_for_string(std::string(37, ' ') + "\t\"" + text + "\"\n" +
+                                           std::string(20, ' ') + "a_1b_2c_3d_4e_5f_6g_7");
+    Token string = t.get_token();
+    EXPECT_EQ(string.get_text(), text);
+    EXPECT_EQ(string.get_position().get_column(), 39u);
+    Token identifier = t.get_token();
+    EXPECT_EQ(identifier.get_text(), "a_1b_2c_3d_4e_5f_6g_7");
+    EXPECT_EQ(identifier.get_position().get_line(), 2u);
+    EXPECT_EQ(identifier.get_position().get_column(), 21u);
+    EXPECT_EQ(t.get_token().get_type(), TokenType::T_EOF);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "engine_test_runner.h"
+
+TEST(VMTest, VMProgram) {
+    auto program = parse_program("int main { ret 5; }");
+    ValType value = run<VirtualMachine>(*program).value;
+
+    ASSERT_TRUE(std::holds_alternative<int>(value));
+    EXPECT_EQ(std::get<int>(value), 5);
+}
+
+TEST(VMTest, VMRecursion) {
+    auto program = parse_program(
+        "int main { ret (10) -> recur_sum; }"
+        "int recur_sum :: int n {"
+        "    if (n <= 1) { ret n; }"
+        "    ret ((n - 1) -> recur_sum) + n;"
+        "}");
+    ValType value = run<VirtualMachine>(*program).value;
+
+    ASSERT_TRUE(std::holds_alternative<int>(value));
+    EXPECT_EQ(std::get<int>(value), 55);
+}
+
+TEST(VMTest, VMNoRetReturnsDefault) {
+    auto program = parse_program(
+        "flt main { () -> nothing => flt a; ret a + 1.5; }"
+        "flt nothing { 5 => int a; }");
+    ValType value = run<VirtualMachine>(*program).value;
+
+    ASSERT_TRUE(std::holds_alternative<double>(value));
+    EXPECT_EQ(std::get<double>(value), 1.5);
+}
+
+TEST(VMTest, VMRetStopsLoop) {
+    auto program = parse_program(
+        "int main {"
+        "    0 => mut int a;"
+        "    while (true) {"
+        "        a + 1 => a;"
+        "        if (a == 3) { ret a; }"
+        "    }"
+        "    ret -1;"
+        "}");
+    ValType value = run<VirtualMachine>(*program).value;
+
+    ASSERT_TRUE(std::holds_alternative<int>(value));
+    EXPECT_EQ(std::get<int>(value), 3);
+}
+
+TEST(VMTest, VMErrorPosition) {
+    auto program = parse_program(
+        "int main {\n"
+        "    1 => int a;\n"
+        "    2 => a;\n"
+        "    ret a;\n"
+        "}");
+    VirtualMachine vm(builtins);
+    try {
+        vm.run(*program);
+        FAIL() << "expected an error";
+    } catch (const GeneralError& e) {
+        EXPECT_EQ(e.get_position().get_line(), 3u);
+    }
+}
+
+struct ParityProgram {
+    std::string program;
+};
+
+class VMParityTest : public ::testing::TestWithParam<ParityProgram> {};
+
+TEST_P(VMParityTest, MatchesTreeInterpreter) {
+    const auto& param = GetParam();
+    std::cout << "TESTING: " << param.program << std::endl;
+    auto program = parse_program(param.program);
+
+    auto expected = run<InterpreterVisitor>(*program);
+    auto actual = run<VirtualMachine>(*program);
+
+    EXPECT_EQ(actual.value, expected.value);
+    EXPECT_EQ(actual.output, expected.output);
+    EXPECT_EQ(actual.error, expected.error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParityPrograms,
+    VMParityTest,
+    ::testing::Values(
+        ParityProgram{"int main { ret 5; }"},
+        ParityProgram{"int main { 0 => mut int a; while (a < 5) { a + 1 => a; } ret a;}"},
+        ParityProgram{"int main { (0) -> add_1 => int a; ret a;} int add_1 :: int a { ret a + 1; }"},
+        ParityProgram{"int main { 0 => mut int a; (a)->add_1; ret a;} "
+                      "int add_1 :: mut int a { a + 1 => a; ret 0; }"},
+        ParityProgram{"int main { 1 => mut int a; (a + 1)->add_1; ret a;} "
+                      "int add_1 :: mut int a { a + 1 => a; ret 0; }"},
+        ParityProgram{"int main { (1) ->> add => [int::int] add_bound; ret (5) -> add_bound; }"
+                      "int add :: int a, int b { ret a + b; }"},
+        ParityProgram{"flt main { 1.5 => mut flt a; (a) -> double; ret a; }"
+                      "void double :: mut flt a { 2 * a => a; }"},
+        ParityProgram{"int main { 1 => mut int a; (a) ->> add => [int::mut int] add_bound;"
+                      "(5) -> add_bound; ret a; }"
+                      "int add :: mut int a, mut int b { a + 2 => a; ret a + b; }"},
+        ParityProgram{"int main { (5) -> bind => [int::int] bound_returned; ret (1) -> bound_returned; }"
+                      "[int::int] bind :: int a { (a) ->> add => [int::int] add_bound; ret add_bound; }"
+                      "int add :: int a, int b { ret a + b; }"},
+        ParityProgram{"int main { add_1 @ decorator => [int::] decorated; ret () -> decorated; }"
+                      "int decorator :: [int::int] func { (5) -> func => int a; ret a + 1; }"
+                      "int add_1 :: int a { ret a + 1; }"},
+        ParityProgram{"int main { 1 => int a; if (a > 0) { ret a; } elif (a == 0) { ret 0; } else { ret -1; } }"},
+        ParityProgram{"int main { 0 => int a; if (a > 0) { ret a; } elif (a == 0) { ret -10; } else { ret -20; } }"},
+        ParityProgram{"int main { -3 => int a; if (a > 0) { ret a; } elif (a == 0) { ret -10; } else { ret -20; } }"},
+        ParityProgram{"int main { 0 => mut int a; while (a < 5) { (a) -> increment; } ret a; }"},
+        ParityProgram{"int main { (0) -> increment; ret 0; }"},
+        ParityProgram{"int main { 1 => int a; (\"HELLO WORLD!\") -> stdout; ret a; }"},
+        ParityProgram{"int main { for (0 => mut int i; i < 5) { } -> increment; ret i; }"},
+        ParityProgram{"int main { 0 => mut int i; for (i; i < 5) { } -> increment; ret i; }"},
+        ParityProgram{"int main { for (0 => mut int i; i < 20) { (i + \"\\n\") -> stdout; }"
+                      "-> increment @ print_current_val; ret 0; }"
+                      "void print_current_val :: [void::mut int] func, mut int a {"
+                      "(a) -> func; (\"LOG: value: \" + a + \"\\n\") -> stdout; }"},
+        ParityProgram{"int main { (100) -> recur_sum => int s; (\"suma to: \" + s + \"\\n\") -> stdout; ret s; }"
+                      "int recur_sum :: int n { if (n <= 1) { ret n; } ret ((n - 1) -> recur_sum) + n; }"},
+        ParityProgram{"int main { 0 => mut int total; 0 => mut int i;"
+                      "while (i < 10) { 0 => mut int j; while (j < i) { total + j => total; j + 1 => j; }"
+                      "i + 1 => i; } ret total; }"},
+        ParityProgram{"int main { (add_1) -> apply => int a; ret a; }"
+                      "int apply :: [int::int] f { ret (1) -> f; } int add_1 :: int a { ret a + 1; }"},
+        ParityProgram{"int main { \"12\" => int a; 2.7 => int b; ret a + b; }"},
+        ParityProgram{"int main { -2.5 => flt a; ret -a; }"},
+        ParityProgram{"int main { if (\"\") { ret 1; } ret 2; }"},
+        ParityProgram{"int main { 0 => mut int a; 1 => mut int b; 0 => mut int i;"
+                      "while (i < 20) { a + b => b; b - a => a; i + 1 => i; } ret a; }"},
+        ParityProgram{"int main { (2.0) -> sqrt_v => flt a; a => mut flt b; (b) -> sqrt;"
+                      "(\"\" + a + \" \" + b + \"\\n\") -> stdout; ret 0; }"},
+        ParityProgram{"flt main { 0.5 => mut flt x; 0 => mut int i;"
+                      "while (i < 10 && x != 3.0) { x * 1.5 - 0.25 => x; i + 1 => i; }"
+                      "ret x + i; }"},
+        ParityProgram{"bool main { \"ab\" => string a; a + \"c\" => string b;"
+                      "ret b == \"abc\" && b != a && 2 - 3 <= -1 && 1.5 >= 1.5; }"},
+        ParityProgram{"int main { (7) -> half => int h; ret h * h - (h > 2); }"
+                      "int half :: int n { ret n / 2; }"},
+        // functions bound again, bound after decorating, and decorators bound
+        ParityProgram{"int main { (1) ->> digits => [int::int, int] d1; (2) ->> d1 => [int::int] d2;"
+                      "(d2) -> show; (4) ->> d1 => [int::int] d4; ret ((3) -> d2) * 1000 + (5) -> d4; }"
+                      "int digits :: int a, int b, int c { ret a * 100 + b * 10 + c; }"
+                      "void show :: [int::int] f { (\"\" + ((7) -> f)) -> stdout; }"},
+        ParityProgram{"int main { add @ twice => [int::int, int] add_twice;"
+                      "(3) ->> add_twice => [int::int] add_twice_3;"
+                      "(2) ->> scale => [int::[int::int], int] double_it;"
+                      "add_1 @ double_it => [int::int] add_1_doubled;"
+                      "ret ((10) -> add_twice_3) * 100 + (10) -> add_1_doubled; }"
+                      "int add :: int a, int b { ret a + b; } int add_1 :: int a { ret a + 1; }"
+                      "int twice :: [int::int, int] func, int a, int b { ret ((a, b) -> func, b) -> func; }"
+                      "int scale :: int k, [int::int] f, int a { ret k * ((a) -> f); }"},
+        // variables declared by a loop body are new in every iteration
+        ParityProgram{"int main { 0 => mut int total; for (0 => mut int i; i < 5) { i * 2 => int twice;"
+                      "(twice) ->> add => [int::int] add_twice; \"<\" + twice => string s; (s) -> stdout;"
+                      "total + (1) -> add_twice => total; } -> increment; ret total; }"
+                      "int add :: int a, int b { ret a + b; }"},
+        // `ret` leaves enclosing loops right away, without running the rest of the iteration
+        ParityProgram{"int main { 0 => mut int a; while (true) { a + 1 => a; (\"-\") -> stdout;"
+                      "if (a == 3) { ret a; } (\"+\") -> stdout; } ret -1; }"},
+        ParityProgram{"int main { for (0 => mut int i; i < 10) { (\"\" + i) -> stdout;"
+                      "if (i == 4) { ret i; } } -> increment @ log; ret -1; }"
+                      "void log :: [void::mut int] func, mut int a { (a) -> func; (\"+\") -> stdout; }"},
+        ParityProgram{"int main { 0 => mut int i; while (i < 5) { 0 => mut int j;"
+                      "while (j < 5) { if (i * j == 6) { ret i * 10 + j; } j + 1 => j; } i + 1 => i; }"
+                      "ret 0; }"},
+        ParityProgram{"int main { (\"a\") -> say; ret () -> zero; }"
+                      "void say :: string s { (s) -> stdout; ret; (\"b\") -> stdout; }"
+                      "int zero { 0 => mut int i; while (true) { i + 1 => i; if (i > 2) { ret; } } ret 1; }"}
+    )
+);
+
+struct InvalidProgram {
+    std::string program;
+};
+
+class VMInvalidPrograms : public ::testing::TestWithParam<InvalidProgram> {};
+
+TEST_P(VMInvalidPrograms, ThrowsLikeTreeInterpreter) {
+    const auto& param = GetParam();
+    std::cout << "Testing: " << param.program << std::endl;
+    auto program = parse_program(param.program);
+
+    auto expected = run<InterpreterVisitor>(*program);
+    auto actual = run<VirtualMachine>(*program);
+    EXPECT_NE(actual.error, "");
+    EXPECT_EQ(actual.error, expected.error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    InvalidPrograms,
+    VMInvalidPrograms,
+    ::testing::Values(
+        InvalidProgram{"int main { ret a; }"},
+        InvalidProgram{"int main { ret \"a\" - 1; }"},
+        InvalidProgram{"int main { ret \"a\" / 1; }"},
+        InvalidProgram{"int main { ret \"a\" * 1.2; }"},
+        InvalidProgram{"int main { ()->increment; }"},
+        InvalidProgram{"int main { 1 => int a; (a)->increment; }"},
+        InvalidProgram{"int main { 1 => mut int a; (a)->increment_v; }"},
+        InvalidProgram{"int main { 1 => mut int a; (a)->stdout; }"},
+        InvalidProgram{"int main { \"abds\" => mut int a; ret 0;}"},
+        InvalidProgram{"int main { (1, 2, 3)->some_func; } void some_func :: int i {ret i;}"},
+        InvalidProgram{"int main { for (a; a < 10) {} -> increment; }"},
+        InvalidProgram{"int main { for (a; a < 10) {} -> nonexistent; }"},
+        InvalidProgram{"int main { (1) -> nonexistent; }"},
+        InvalidProgram{"int main { 1 => mut int a; 2 => mut int a; }"},
+        InvalidProgram{"int main { 1 => int a; 2 => string a; }"},
+        InvalidProgram{"int main { 1 => mut int a; (a) -> sqrt_v; }"},
+        InvalidProgram{"int main { 1 => int a; (a) -> sqrt; }"},
+        InvalidProgram{"int main { (1) ->> undefined; }"},
+        InvalidProgram{"int main { (1) -> und @ efined; }"},
+        InvalidProgram{"int main { 1 => int a; 2 => a; }"},
+        InvalidProgram{"int main { 2 => b; }"},
+        InvalidProgram{"int main { for (0 => mut int i; i < 10) {} -> i; }"},
+        InvalidProgram{"int main { } int main { }"}
+        )
+);